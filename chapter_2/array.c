@@ -1,13 +1,28 @@
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+#define RADIX_BITS 11 // bits sorted per pass: 11 + 11 + 10 covers an int
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define RADIX_PASSES ((32 + RADIX_BITS - 1) / RADIX_BITS)
+#define QUADRATIC_MAX 100000 // largest size the O(n^2) sorts are timed on
+
 void printa(const int arr[], size_t size);
 void bubble_sort(int arr[], const int size);
 void selection_sort(int arr[], int n);
+void radix_sort(int arr[], size_t n);
 int *gen_rand_arr(int size, int max);
+void benchmark(int size, int max);
+
+int main(int argc, char *argv[]) {
+  // ./array N [MAX] times the sorts on N random values below MAX
+  if (argc > 1) {
+    benchmark(atoi(argv[1]), argc > 2 ? atoi(argv[2]) : 10000);
+    return 0;
+  }
 
-int main() {
   int size = 1000;
   int max = 10000;
 
@@ -78,6 +93,140 @@ void selection_sort(int arr[], int n) {
   }
 }
 
+// Sort n ints with a least-significant-digit radix sort, RADIX_BITS bits per
+// pass. One read of the array fills the histograms of every digit up front. A
+// pass whose digit is the same for every element would only copy the array,
+// so it is skipped; with small values the high passes all drop out. Flipping
+// the sign bit turns signed order into unsigned order, so negative values
+// sort first.
+void radix_sort(int arr[], size_t n) {
+  size_t counts[RADIX_PASSES][RADIX_SIZE]; // 48 KB, fine on the stack
+  uint32_t *src = (uint32_t *)arr;
+  uint32_t *dst;
+
+  if (n < 2) {
+    return;
+  }
+  dst = malloc(n * sizeof(uint32_t));
+  if (dst == NULL) {
+    printf("Memory allocation failed!\n");
+    exit(1);
+  }
+
+  // Histogram pre-pass over the keys with the sign bit flipped
+  memset(counts, 0, sizeof(counts));
+  for (size_t i = 0; i < n; i++) {
+    uint32_t key = src[i] ^ 0x80000000u;
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+      counts[pass][(key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+    }
+  }
+
+  for (int pass = 0; pass < RADIX_PASSES; pass++) {
+    int shift = pass * RADIX_BITS;
+    size_t *count = counts[pass];
+
+    // Skip the pass if every element has the same digit
+    uint32_t digit = ((src[0] ^ 0x80000000u) >> shift) & (RADIX_SIZE - 1);
+    if (count[digit] == n) {
+      continue;
+    }
+
+    // Turn the counts into the first output index of each digit
+    size_t sum = 0;
+    for (int d = 0; d < RADIX_SIZE; d++) {
+      size_t c = count[d];
+      count[d] = sum;
+      sum += c;
+    }
+
+    // Stable scatter by this digit
+    for (size_t i = 0; i < n; i++) {
+      uint32_t key = src[i] ^ 0x80000000u;
+      dst[count[(key >> shift) & (RADIX_SIZE - 1)]++] = src[i];
+    }
+
+    uint32_t *temp = src;
+    src = dst;
+    dst = temp;
+  }
+
+  // After an odd number of passes the result is in the scratch buffer
+  if (src != (uint32_t *)arr) {
+    memcpy(arr, src, n * sizeof(uint32_t));
+    dst = src;
+  }
+  free(dst);
+}
+
+static double elapsed(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int compare_ints(const void *a, const void *b) {
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+// Time one sort on a copy of numbers and check the result against sorted
+static void time_sort(const char *name, void (*sort)(int arr[], int n),
+                      const int numbers[], const int sorted[], int size) {
+  struct timespec start;
+  int *arr = malloc(size * sizeof(int));
+
+  if (arr == NULL) {
+    printf("Memory allocation failed!\n");
+    exit(1);
+  }
+  memcpy(arr, numbers, size * sizeof(int));
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  sort(arr, size);
+  double secs = elapsed(&start);
+
+  printf("%-15s %10.2f ns/element%s\n", name, secs * 1e9 / size,
+         memcmp(arr, sorted, size * sizeof(int)) == 0 ? "" : "  WRONG");
+  free(arr);
+}
+
+static void bubble_sort_n(int arr[], int n) { bubble_sort(arr, n); }
+static void radix_sort_n(int arr[], int n) { radix_sort(arr, n); }
+static void qsort_n(int arr[], int n) {
+  qsort(arr, n, sizeof(int), compare_ints);
+}
+
+// Compare the sorts on size values from gen_rand_arr(size, max). The O(n^2)
+// sorts are only timed up to QUADRATIC_MAX values; libc qsort() is the
+// reference the others are checked against.
+void benchmark(int size, int max) {
+  if (size < 1 || max < 1) {
+    printf("size and max must be positive\n");
+    return;
+  }
+
+  int *numbers = gen_rand_arr(size, max);
+  int *sorted = malloc(size * sizeof(int));
+  if (sorted == NULL) {
+    printf("Memory allocation failed!\n");
+    exit(1);
+  }
+  memcpy(sorted, numbers, size * sizeof(int));
+  qsort(sorted, size, sizeof(int), compare_ints);
+
+  printf("%d values below %d\n", size, max);
+  if (size <= QUADRATIC_MAX) {
+    time_sort("bubble_sort", bubble_sort_n, numbers, sorted, size);
+    time_sort("selection_sort", selection_sort, numbers, sorted, size);
+  }
+  time_sort("qsort", qsort_n, numbers, sorted, size);
+  time_sort("radix_sort", radix_sort_n, numbers, sorted, size);
+
+  free(sorted);
+  free(numbers);
+}
+
 void printa(const int arr[], size_t size) {
   printf("[");
   for (size_t i = 0; i < size; ++i) {
@@ -1,26 +1,88 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #define TABLE_SIZE 100
+#define INLINE_KEY_SIZE 16 // keys shorter than this are stored in the entry
+#define BUILD_BATCH 16     // keys hashed (and buckets prefetched) at a time
+#define LOOKUP_BATCH 16    // keys resolved together by search_many()
+#define STATS_HIST_SIZE 8  // chain lengths 0..6, the last bin is 7 or more
 
-typedef struct {
-  char *key;
+typedef struct Entry {
+  unsigned int hash; // full hash of the key, checked before the key bytes
+  unsigned int len;  // key length, not counting the '\0'
+  union {
+    char inline_key[INLINE_KEY_SIZE]; // short keys live inside the entry
+    char *heap_key;                   // long keys keep an out-of-line copy
+  } key;
   int value;
   struct Entry *next;
 } Entry;
 
 typedef struct {
   Entry **buckets;
+  size_t size;          // number of buckets
+  size_t count;         // number of live entries
+  Entry *free_entries;  // erased entries, reused by the next insert()
+  size_t free_count;    // number of entries on the free list
+  size_t heap_bytes;    // entries and keys malloc'd outside slab and arena
+  Entry *slab;          // entries placed in one allocation by build_table()
+  size_t slab_len;      // number of entries in the slab
+  char *key_arena;      // long keys placed in one allocation with the slab
+  size_t key_arena_len; // bytes in the key arena
 } HashTable;
 
-unsigned int hash(const char *key);
-Entry *create_entry(const char *key, int value);
+// Snapshot of a table's shape, filled in by table_stats()
+typedef struct {
+  size_t buckets;
+  size_t entries;      // live entries
+  double load_factor;  // entries per bucket
+  size_t free_entries; // erased entries parked for reuse
+  size_t bytes;        // everything the table holds, bucket array included
+  double bytes_per_entry;
+  // The rest comes from a walk over every stride-th bucket only
+  size_t sampled_buckets;
+  size_t chain_hist[STATS_HIST_SIZE]; // sampled buckets by chain length
+  size_t max_chain;                   // longest sampled chain
+  double avg_probes; // entries compared by a successful search, on average
+} TableStats;
+
+// Cursor over the live entries of a table, in bucket order
+typedef struct {
+  const HashTable *table;
+  size_t bucket; // next bucket to visit
+  const Entry *entry;
+} TableIter;
+
+unsigned int hash(const char *key, size_t len);
+Entry *create_entry(const char *key, size_t len, unsigned int h, int value);
+const char *entry_key(const Entry *entry);
+int entry_matches(const Entry *entry, const char *key, size_t len,
+                  unsigned int h);
 HashTable *create_table();
+HashTable *create_table_sized(size_t size);
+HashTable *build_table(const char *keys[], const int values[], size_t n);
+void free_table(HashTable *table);
+void compact_table(HashTable *table);
 void insert(HashTable *table, const char *key, int value);
+int erase(HashTable *table, const char *key);
 int search(HashTable *table, const char *key, int *value);
+size_t search_many(HashTable *table, const char *keys[], size_t n,
+                   int values[], int found[]);
+void table_stats(const HashTable *table, size_t stride, TableStats *stats);
+void print_stats(const TableStats *stats);
+void table_iter_init(TableIter *it, const HashTable *table);
+int table_iter_next(TableIter *it, const char **key, int *value);
 void print_table(const HashTable *table);
+void benchmark(size_t n);
+
+int main(int argc, char *argv[]) {
+  // ./hashmap N times loading and looking up N keys
+  if (argc > 1) {
+    benchmark(strtoul(argv[1], NULL, 10));
+    return 0;
+  }
 
-int main(void) {
   HashTable *table = create_table();
 
   // Insert key-value pairs
@@ -28,42 +90,109 @@ int main(void) {
   insert(table, "Bob", 30);
   insert(table, "Seyfi", 59);
   insert(table, "Leyli", 54);
+  insert(table, "Maximilian-Alexander", 41); // long key, stored out of line
 
   // Search for a key
   int age;
   if (search(table, "Can", &age)) {
     printf("Can's age is: %d\n", age);
   } else {
-    printf("Can was not found");
+    printf("Can was not found\n");
   }
 
+  if (search(table, "Maximilian-Alexander", &age)) {
+    printf("Maximilian-Alexander's age is: %d\n", age);
+  }
+
+  // Updating an existing key replaces its value instead of adding an entry
+  insert(table, "Bob", 31);
+  erase(table, "Seyfi");
+
   print_table(table);
 
-  free(table);
+  // Repack the surviving entries next to each other
+  compact_table(table);
+
+  TableStats stats;
+  table_stats(table, 1, &stats);
+  print_stats(&stats);
+
+  // Walk every live entry
+  TableIter it;
+  const char *name;
+  table_iter_init(&it, table);
+  while (table_iter_next(&it, &name, &age)) {
+    printf("%s is %d\n", name, age);
+  }
+
+  free_table(table);
+
+  // Build a second table in one go from parallel key/value arrays
+  const char *names[] = {"Can", "Deniz", "Ece", "Fatma-Nur-Gulsen-Hatice"};
+  const int ages[] = {31, 28, 35, 62};
+  HashTable *built = build_table(names, ages, 4);
+
+  // Look several keys up at once
+  const char *wanted[] = {"Ece", "Alice", "Fatma-Nur-Gulsen-Hatice"};
+  int wanted_ages[3], found[3];
+  search_many(built, wanted, 3, wanted_ages, found);
+  for (int i = 0; i < 3; i++) {
+    if (found[i]) {
+      printf("%s's age is: %d\n", wanted[i], wanted_ages[i]);
+    } else {
+      printf("%s was not found\n", wanted[i]);
+    }
+  }
+  print_table(built);
+
+  free_table(built);
 }
 
-Entry *create_entry(const char *key, int value) {
+Entry *create_entry(const char *key, size_t len, unsigned int h, int value) {
   Entry *new_entry = malloc(sizeof(Entry));
   if (!new_entry) {
     fprintf(stderr, "Failed to allocate memory for entry.\n");
     exit(EXIT_FAILURE);
   }
 
-  new_entry->key = strdup(key);
+  if (len < INLINE_KEY_SIZE) {
+    // Short key: copy it (and its '\0') straight into the entry
+    memcpy(new_entry->key.inline_key, key, len + 1);
+  } else {
+    new_entry->key.heap_key = malloc(len + 1);
 
-  if (!new_entry->key) {
-    fprintf(stderr, "Failed to duplicate key.\n");
-    free(new_entry);
-    exit(EXIT_FAILURE);
+    if (!new_entry->key.heap_key) {
+      fprintf(stderr, "Failed to duplicate key.\n");
+      free(new_entry);
+      exit(EXIT_FAILURE);
+    }
+    memcpy(new_entry->key.heap_key, key, len + 1);
   }
 
+  new_entry->hash = h;
+  new_entry->len = len;
   new_entry->value = value;
   new_entry->next = NULL;
 
   return new_entry;
 }
 
-HashTable *create_table() {
+// Return the key bytes of an entry, wherever they are stored
+const char *entry_key(const Entry *entry) {
+  return entry->len < INLINE_KEY_SIZE ? entry->key.inline_key
+                                      : entry->key.heap_key;
+}
+
+// Compare hash and length first so most mismatches never touch the key bytes
+int entry_matches(const Entry *entry, const char *key, size_t len,
+                  unsigned int h) {
+  return entry->hash == h && entry->len == len &&
+         memcmp(entry_key(entry), key, len) == 0;
+}
+
+HashTable *create_table() { return create_table_sized(TABLE_SIZE); }
+
+HashTable *create_table_sized(size_t size) {
   HashTable *table = malloc(sizeof(HashTable));
 
   if (!table) {
@@ -71,51 +200,318 @@ HashTable *create_table() {
     exit(EXIT_FAILURE);
   }
 
-  table->buckets = malloc(sizeof(Entry *) * TABLE_SIZE);
+  table->buckets = malloc(sizeof(Entry *) * size);
   if (!table->buckets) {
     fprintf(stderr, "Failed to allocate memory for buckets.\n");
     free(table);
     exit(EXIT_FAILURE);
   }
 
-  for (int i = 0; i < TABLE_SIZE; i++) {
+  for (size_t i = 0; i < size; i++) {
     table->buckets[i] = NULL;
   }
 
+  table->size = size;
+  table->count = 0;
+  table->free_entries = NULL;
+  table->free_count = 0;
+  table->heap_bytes = 0;
+  table->slab = NULL;
+  table->slab_len = 0;
+  table->key_arena = NULL;
+  table->key_arena_len = 0;
+
+  return table;
+}
+
+/*
+ * Build a table from n key/value pairs at once. The bucket array is sized for
+ * n up front, all entries come from a single slab and all long keys from a
+ * single arena, so the whole load costs a handful of allocations instead of
+ * one or two per key. Keys are hashed one batch ahead of placement, so the
+ * buckets of the next BUILD_BATCH keys are already being fetched while the
+ * current batch is linked in. As with insert(), a repeated key keeps a single
+ * entry holding the last value.
+ */
+HashTable *build_table(const char *keys[], const int values[], size_t n) {
+  HashTable *table = create_table_sized(n + n / 3 + 1);
+  unsigned int *lens = malloc(sizeof(unsigned int) * (n ? n : 1));
+  size_t arena_size = 0;
+
+  if (!lens) {
+    fprintf(stderr, "Failed to allocate memory for key lengths.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    lens[i] = strlen(keys[i]);
+    if (lens[i] >= INLINE_KEY_SIZE) {
+      arena_size += lens[i] + 1;
+    }
+  }
+
+  table->slab = malloc(sizeof(Entry) * (n ? n : 1));
+  table->key_arena = malloc(arena_size ? arena_size : 1);
+  table->key_arena_len = arena_size;
+  if (!table->slab || !table->key_arena) {
+    fprintf(stderr, "Failed to allocate memory for entries.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  char *arena = table->key_arena;
+  unsigned int hashes[2][BUILD_BATCH]; // current batch and the one after it
+  size_t batches = (n + BUILD_BATCH - 1) / BUILD_BATCH;
+
+  for (size_t batch = 0; batch <= batches; batch++) {
+    // Hash the next batch and start pulling its buckets into cache
+    size_t start = batch * BUILD_BATCH;
+    for (size_t i = start; i < n && i < start + BUILD_BATCH; i++) {
+      unsigned int h = hash(keys[i], lens[i]);
+      hashes[batch % 2][i - start] = h;
+      __builtin_prefetch(&table->buckets[h % table->size], 1);
+    }
+    if (batch == 0) {
+      continue;
+    }
+
+    // Link in the previous batch, whose buckets should now be cached. The
+    // chain heads are fetched together first, since each key has to be
+    // checked against its chain before it gets an entry of its own.
+    start -= BUILD_BATCH;
+    for (size_t i = start; i < n && i < start + BUILD_BATCH; i++) {
+      unsigned int h = hashes[(batch - 1) % 2][i - start];
+      if (table->buckets[h % table->size] != NULL) {
+        __builtin_prefetch(table->buckets[h % table->size]);
+      }
+    }
+    for (size_t i = start; i < n && i < start + BUILD_BATCH; i++) {
+      unsigned int h = hashes[(batch - 1) % 2][i - start];
+      Entry **bucket = &table->buckets[h % table->size];
+      Entry *entry = *bucket;
+
+      while (entry != NULL && !entry_matches(entry, keys[i], lens[i], h)) {
+        entry = entry->next;
+      }
+      if (entry != NULL) {
+        entry->value = values[i]; // repeated key, keep the later value
+        continue;
+      }
+
+      entry = &table->slab[table->slab_len++];
+
+      if (lens[i] < INLINE_KEY_SIZE) {
+        memcpy(entry->key.inline_key, keys[i], lens[i] + 1);
+      } else {
+        memcpy(arena, keys[i], lens[i] + 1);
+        entry->key.heap_key = arena;
+        arena += lens[i] + 1;
+      }
+      entry->hash = h;
+      entry->len = lens[i];
+      entry->value = values[i];
+      entry->next = *bucket;
+      *bucket = entry;
+      table->count++;
+    }
+  }
+
+  free(lens);
   return table;
 }
 
-unsigned int hash(const char *key) {
+// Entries placed by build_table() are released with the slab, not one by one
+static int in_slab(const HashTable *table, const Entry *entry) {
+  return table->slab != NULL && entry >= table->slab &&
+         entry < table->slab + table->slab_len;
+}
+
+// Free a long key unless it lives in the key arena; returns the bytes freed
+static size_t release_key(const HashTable *table, Entry *entry) {
+  if (entry->len >= INLINE_KEY_SIZE &&
+      !(entry->key.heap_key >= table->key_arena &&
+        entry->key.heap_key < table->key_arena + table->key_arena_len)) {
+    free(entry->key.heap_key);
+    return entry->len + 1;
+  }
+  return 0;
+}
+
+static void release_chain(const HashTable *table, Entry *entry,
+                          int with_keys) {
+  while (entry != NULL) {
+    Entry *next = entry->next;
+    if (with_keys) {
+      release_key(table, entry);
+    }
+    if (!in_slab(table, entry)) {
+      free(entry);
+    }
+    entry = next;
+  }
+}
+
+void free_table(HashTable *table) {
+  for (size_t i = 0; i < table->size; i++) {
+    release_chain(table, table->buckets[i], 1);
+  }
+  release_chain(table, table->free_entries, 0); // keys already released
+  free(table->slab);
+  free(table->key_arena);
+  free(table->buckets);
+  free(table);
+}
+
+/*
+ * Move every live entry into a fresh slab, with each chain stored as a run of
+ * neighbouring entries and all long keys in a fresh arena, then release the
+ * old entries and the free list. Worth calling after heavy erase/insert churn
+ * has scattered the chains or left many entries parked on the free list.
+ */
+void compact_table(HashTable *table) {
+  Entry *slab = malloc(sizeof(Entry) * (table->count ? table->count : 1));
+  size_t arena_size = 0;
+
+  for (size_t i = 0; i < table->size; i++) {
+    for (Entry *e = table->buckets[i]; e != NULL; e = e->next) {
+      if (e->len >= INLINE_KEY_SIZE) {
+        arena_size += e->len + 1;
+      }
+    }
+  }
+
+  char *key_arena = malloc(arena_size ? arena_size : 1);
+  if (!slab || !key_arena) {
+    fprintf(stderr, "Failed to allocate memory for compaction.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  size_t used = 0;
+  char *arena = key_arena;
+  for (size_t i = 0; i < table->size; i++) {
+    Entry *old_chain = table->buckets[i];
+    Entry **link = &table->buckets[i];
+
+    for (Entry *old = old_chain; old != NULL; old = old->next) {
+      Entry *entry = &slab[used++];
+
+      *entry = *old;
+      if (old->len >= INLINE_KEY_SIZE) {
+        memcpy(arena, old->key.heap_key, old->len + 1);
+        entry->key.heap_key = arena;
+        arena += old->len + 1;
+      }
+      *link = entry;
+      link = &entry->next;
+    }
+    *link = NULL;
+
+    release_chain(table, old_chain, 1);
+  }
+  release_chain(table, table->free_entries, 0);
+
+  free(table->slab);
+  free(table->key_arena);
+  table->free_entries = NULL;
+  table->free_count = 0;
+  table->heap_bytes = 0;
+  table->slab = slab;
+  table->slab_len = used;
+  table->key_arena = key_arena;
+  table->key_arena_len = arena_size;
+}
+
+// Returns the full hash; callers reduce it to a bucket index themselves
+unsigned int hash(const char *key, size_t len) {
   unsigned long int value = 0;
   unsigned int i = 0;
-  unsigned int key_len = strlen(key);
 
-  for (; i < key_len; i++) {
+  for (; i < len; i++) {
     value = value * 37 + key[i];
   }
 
-  return value % TABLE_SIZE;
+  return value;
 }
 
+// Insert key with value, or update the value if key is already present
 void insert(HashTable *table, const char *key, int value) {
-  unsigned int bucket = hash(key);
+  size_t len = strlen(key);
+  unsigned int h = hash(key, len);
+  unsigned int bucket = h % table->size;
 
-  Entry *new_entry = create_entry(key, value);
+  for (Entry *entry = table->buckets[bucket]; entry != NULL;
+       entry = entry->next) {
+    if (entry_matches(entry, key, len, h)) {
+      entry->value = value;
+      return;
+    }
+  }
 
-  if (table->buckets[bucket] == NULL) {
-    table->buckets[bucket] = new_entry;
+  Entry *new_entry;
+  if (table->free_entries != NULL) {
+    // Reuse an erased entry rather than growing the heap
+    new_entry = table->free_entries;
+    table->free_entries = new_entry->next;
+    table->free_count--;
+    if (len < INLINE_KEY_SIZE) {
+      memcpy(new_entry->key.inline_key, key, len + 1);
+    } else {
+      new_entry->key.heap_key = malloc(len + 1);
+      if (!new_entry->key.heap_key) {
+        fprintf(stderr, "Failed to duplicate key.\n");
+        exit(EXIT_FAILURE);
+      }
+      memcpy(new_entry->key.heap_key, key, len + 1);
+      table->heap_bytes += len + 1;
+    }
+    new_entry->hash = h;
+    new_entry->len = len;
+    new_entry->value = value;
   } else {
-    new_entry->next = table->buckets[bucket];
-    table->buckets[bucket] = new_entry;
+    new_entry = create_entry(key, len, h, value);
+    table->heap_bytes +=
+        sizeof(Entry) + (len >= INLINE_KEY_SIZE ? len + 1 : 0);
   }
+
+  new_entry->next = table->buckets[bucket];
+  table->buckets[bucket] = new_entry;
+  table->count++;
+}
+
+/*
+ * Remove key from the table. Returns 1 if it was present, 0 otherwise. Chains
+ * need no tombstones: the entry is unlinked on the spot and parked on the
+ * free list, so the next insert() reuses it and the table never holds more
+ * entries than its peak number of live keys.
+ */
+int erase(HashTable *table, const char *key) {
+  size_t len = strlen(key);
+  unsigned int h = hash(key, len);
+  Entry **link = &table->buckets[h % table->size];
+
+  while (*link != NULL) {
+    Entry *entry = *link;
+    if (entry_matches(entry, key, len, h)) {
+      *link = entry->next;
+      table->heap_bytes -= release_key(table, entry);
+      entry->next = table->free_entries;
+      table->free_entries = entry;
+      table->free_count++;
+      table->count--;
+      return 1;
+    }
+    link = &entry->next;
+  }
+
+  return 0;
 }
 
 int search(HashTable *table, const char *key, int *value) {
-  unsigned int bucket = hash(key);
-  Entry *entry = table->buckets[bucket];
+  size_t len = strlen(key);
+  unsigned int h = hash(key, len);
+  Entry *entry = table->buckets[h % table->size];
 
   while (entry != NULL) {
-    if (strcmp(entry->key, key) == 0) {
+    if (entry_matches(entry, key, len, h)) {
       // Key found
       *value = entry->value;
       return 1;
@@ -127,17 +523,245 @@ int search(HashTable *table, const char *key, int *value) {
   return 0;
 }
 
+/*
+ * Look up n keys at once. found[i] is set to 1 and values[i] to the value if
+ * keys[i] is present, otherwise found[i] is set to 0. The keys are processed
+ * LOOKUP_BATCH at a time in three sweeps: hash every key and prefetch its
+ * bucket slot, then read the bucket heads and prefetch the first entries,
+ * then walk the chains. The cache misses of a batch overlap instead of being
+ * paid one lookup after another. Returns the number of keys found.
+ */
+size_t search_many(HashTable *table, const char *keys[], size_t n,
+                   int values[], int found[]) {
+  unsigned int hashes[LOOKUP_BATCH];
+  size_t lens[LOOKUP_BATCH];
+  Entry *heads[LOOKUP_BATCH];
+  size_t hits = 0;
+
+  for (size_t start = 0; start < n; start += LOOKUP_BATCH) {
+    size_t count = n - start < LOOKUP_BATCH ? n - start : LOOKUP_BATCH;
+
+    for (size_t i = 0; i < count; i++) {
+      lens[i] = strlen(keys[start + i]);
+      hashes[i] = hash(keys[start + i], lens[i]);
+      __builtin_prefetch(&table->buckets[hashes[i] % table->size]);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      heads[i] = table->buckets[hashes[i] % table->size];
+      if (heads[i] != NULL) {
+        __builtin_prefetch(heads[i]);
+      }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      Entry *entry = heads[i];
+
+      while (entry != NULL &&
+             !entry_matches(entry, keys[start + i], lens[i], hashes[i])) {
+        entry = entry->next;
+      }
+      found[start + i] = entry != NULL;
+      if (entry != NULL) {
+        values[start + i] = entry->value;
+        hits++;
+      }
+    }
+  }
+
+  return hits;
+}
+
+/*
+ * Fill in stats for table. Counts and sizes are kept up to date by insert()
+ * and erase(), so they cost nothing; the chain histogram needs a walk, which
+ * only visits every stride-th bucket. A stride of 1 walks the whole table, a
+ * stride of 64 touches 1/64 of it and is cheap enough to run on a live
+ * table now and then.
+ */
+void table_stats(const HashTable *table, size_t stride, TableStats *stats) {
+  size_t probes = 0, sampled_entries = 0;
+
+  memset(stats, 0, sizeof(*stats));
+  stats->buckets = table->size;
+  stats->entries = table->count;
+  stats->load_factor = (double)table->count / table->size;
+  stats->free_entries = table->free_count;
+  stats->bytes = sizeof(HashTable) + sizeof(Entry *) * table->size +
+                 sizeof(Entry) * table->slab_len + table->key_arena_len +
+                 table->heap_bytes;
+  stats->bytes_per_entry =
+      table->count ? (double)stats->bytes / table->count : 0;
+
+  for (size_t i = 0; i < table->size; i += stride ? stride : 1) {
+    size_t len = 0;
+    for (const Entry *entry = table->buckets[i]; entry != NULL;
+         entry = entry->next) {
+      len++;
+    }
+
+    stats->sampled_buckets++;
+    stats->chain_hist[len < STATS_HIST_SIZE ? len : STATS_HIST_SIZE - 1]++;
+    if (len > stats->max_chain) {
+      stats->max_chain = len;
+    }
+    // Finding the k-th entry of a chain takes k comparisons
+    probes += len * (len + 1) / 2;
+    sampled_entries += len;
+  }
+
+  stats->avg_probes = sampled_entries ? (double)probes / sampled_entries : 0;
+}
+
+void print_stats(const TableStats *stats) {
+  printf("%zu entries in %zu buckets (load factor %.2f), %zu free\n",
+         stats->entries, stats->buckets, stats->load_factor,
+         stats->free_entries);
+  printf("%zu bytes, %.1f bytes per entry\n", stats->bytes,
+         stats->bytes_per_entry);
+  printf("chain lengths over %zu sampled buckets (max %zu, %.2f probes per "
+         "hit):\n",
+         stats->sampled_buckets, stats->max_chain, stats->avg_probes);
+  for (int i = 0; i < STATS_HIST_SIZE; i++) {
+    printf("  %d%s: %zu\n", i, i == STATS_HIST_SIZE - 1 ? "+" : "",
+           stats->chain_hist[i]);
+  }
+}
+
+void table_iter_init(TableIter *it, const HashTable *table) {
+  it->table = table;
+  it->bucket = 0;
+  it->entry = NULL;
+}
+
+/*
+ * Advance to the next live entry and store its key and value. Returns 0 once
+ * every entry has been visited. The bucket array is scanned in order, and the
+ * head of the next non-empty bucket is prefetched while the current chain is
+ * being handed out.
+ */
+int table_iter_next(TableIter *it, const char **key, int *value) {
+  const HashTable *table = it->table;
+
+  while (it->entry == NULL) {
+    if (it->bucket >= table->size) {
+      return 0;
+    }
+    it->entry = table->buckets[it->bucket++];
+  }
+
+  if (it->entry->next == NULL) {
+    for (size_t b = it->bucket; b < table->size && b < it->bucket + 8; b++) {
+      if (table->buckets[b] != NULL) {
+        __builtin_prefetch(table->buckets[b]);
+        break;
+      }
+    }
+  }
+
+  *key = entry_key(it->entry);
+  *value = it->entry->value;
+  it->entry = it->entry->next;
+  return 1;
+}
+
 void print_table(const HashTable *table) {
-  for (int i = 0; i < TABLE_SIZE; i++) {
+  for (size_t i = 0; i < table->size; i++) {
     Entry *entry = table->buckets[i];
     if (entry == NULL) {
       continue;
     }
-    printf("Bucket[%d]: ", i);
+    printf("Bucket[%zu]: ", i);
     while (entry != NULL) {
-      printf("(%s: %d) -> ", entry->key, entry->value);
+      printf("(%s: %d) -> ", entry_key(entry), entry->value);
       entry = entry->next;
     }
     printf("NULL\n");
   }
 }
+
+static double elapsed(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void benchmark(size_t n) {
+  const char **keys = malloc(sizeof(char *) * n);
+  int *values = malloc(sizeof(int) * n);
+  int *found = malloc(sizeof(int) * n);
+  char *key_text = malloc(n * 24);
+  struct timespec start;
+
+  if (!keys || !values || !found || !key_text) {
+    fprintf(stderr, "Failed to allocate memory for benchmark keys.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    snprintf(key_text + i * 24, 24, "user:%u",
+             (unsigned int)(i * 2654435761u % (n * 4)));
+    keys[i] = key_text + i * 24;
+    values[i] = (int)i;
+  }
+
+  // insert() gets a pre-sized table too, so only the load path differs. Each
+  // path runs twice and the faster run counts, so neither one is charged for
+  // first-touch page faults the other already paid.
+  double insert_secs = 0, build_secs = 0;
+  for (int round = 0; round < 2; round++) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    HashTable *table = create_table_sized(n + n / 3 + 1);
+    for (size_t i = 0; i < n; i++) {
+      insert(table, keys[i], values[i]);
+    }
+    double secs = elapsed(&start);
+    insert_secs = round == 0 || secs < insert_secs ? secs : insert_secs;
+    free_table(table);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    table = build_table(keys, values, n);
+    secs = elapsed(&start);
+    build_secs = round == 0 || secs < build_secs ? secs : build_secs;
+    free_table(table);
+  }
+
+  printf("%zu keys: insert() %.3f s, build_table() %.3f s\n", n, insert_secs,
+         build_secs);
+
+  // Look every key up again, one search() at a time and 32 keys per
+  // search_many() call, in reverse order so neighbouring lookups are
+  // unrelated
+  HashTable *table = build_table(keys, values, n);
+  size_t search_hits = 0, many_hits = 0; // every key is in the table
+  int value;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t i = n; i-- > 0;) {
+    search_hits += search(table, keys[i], &value);
+  }
+  double search_secs = elapsed(&start);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t i = n; i > 0;) {
+    size_t count = i < 32 ? i : 32;
+    i -= count;
+    many_hits += search_many(table, keys + i, count, values + i, found + i);
+  }
+  double many_secs = elapsed(&start);
+
+  printf("%zu lookups: search() %.3f s (%zu hits), search_many() %.3f s "
+         "(%zu hits)%s\n",
+         n, search_secs, search_hits, many_secs, many_hits,
+         search_hits != n || many_hits != n ? "  WRONG" : "");
+
+  TableStats stats;
+  table_stats(table, 64, &stats);
+  print_stats(&stats);
+  free_table(table);
+
+  free(key_text);
+  free(found);
+  free(values);
+  free(keys);
+}
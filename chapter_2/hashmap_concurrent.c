@@ -0,0 +1,389 @@
+/*
+ * Concurrent variant of hashmap.c
+ *
+ * Readers walk the chains without taking any lock. Writers serialize per shard
+ * (a bucket belongs to shard bucket % SHARD_COUNT), so inserts into different
+ * shards proceed in parallel. Entries are never modified after they are
+ * published: updating a key links in a fresh copy and retires the old one.
+ *
+ * Retired entries are freed with epoch-based reclamation. Every thread owns a
+ * slot announcing the global epoch it observed on entering a read-side
+ * critical section (zero while it is outside one). The global epoch only
+ * advances once every active thread has caught up with it, so an entry retired
+ * in epoch e can no longer be seen by anyone once the global epoch reaches
+ * e + 2.
+ *
+ * Build: cc -O2 -pthread hashmap_concurrent.c
+ * Usage: ./a.out [max_threads]   (runs the 95/5 read/write benchmark)
+ */
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TABLE_SIZE (1 << 16) // power of two so the bucket is a mask
+#define CACHE_LINE 64
+#define SHARD_COUNT 64
+#define MAX_THREADS 64
+#define RETIRE_BATCH 64 // try to reclaim after this many retirements
+
+#define KEY_SPACE 100000
+#define OPS_PER_THREAD 1000000
+#define WRITE_PERCENT 5
+#define KEY_LEN 16 // room for "key" and any index below KEY_SPACE
+
+typedef struct Entry {
+  unsigned int hash;
+  unsigned int len;
+  int value;
+  struct Entry *_Atomic next;
+  struct Entry *retired_next; // link in the owner's retire list
+  unsigned long retire_epoch;
+  char key[]; // immutable once the entry is published
+} Entry;
+
+// One shard per cache line: the alignment also rounds the size up to it
+typedef struct {
+  _Alignas(CACHE_LINE) pthread_mutex_t lock;
+} Shard;
+
+typedef struct {
+  Entry *_Atomic *buckets;
+  Shard shards[SHARD_COUNT];
+} HashTable;
+
+// Per-thread epoch announcement, one per cache line so readers don't
+// false-share
+typedef struct {
+  _Alignas(CACHE_LINE) atomic_ulong epoch; // 0 when the thread is not reading
+} EpochSlot;
+
+// Per-thread handle: epoch slot plus the entries this thread has retired
+typedef struct {
+  EpochSlot *slot;
+  Entry *retired;
+  size_t retired_count;
+} ThreadCtx;
+
+static atomic_ulong global_epoch = 2;
+static EpochSlot epoch_slots[MAX_THREADS];
+
+unsigned int hash(const char *key, size_t len);
+HashTable *create_table(void);
+void free_table(HashTable *table);
+void thread_ctx_init(ThreadCtx *ctx, int id);
+void thread_ctx_release(ThreadCtx *ctx);
+void insert(HashTable *table, ThreadCtx *ctx, const char *key, int value);
+int search(HashTable *table, ThreadCtx *ctx, const char *key, int *value);
+
+static void epoch_enter(ThreadCtx *ctx);
+static void epoch_exit(ThreadCtx *ctx);
+static void retire(ThreadCtx *ctx, Entry *entry);
+static void try_reclaim(ThreadCtx *ctx);
+
+int main(int argc, char *argv[]) {
+  int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+  if (max_threads < 1 || max_threads > MAX_THREADS) {
+    fprintf(stderr, "max_threads must be between 1 and %d\n", MAX_THREADS);
+    return EXIT_FAILURE;
+  }
+
+  void run_benchmark(int threads);
+
+  printf("threads  reads/s       writes/s\n");
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    run_benchmark(threads);
+  }
+
+  return 0;
+}
+
+HashTable *create_table(void) {
+  // malloc() only aligns to 16 bytes, too little for the shards
+  HashTable *table = aligned_alloc(CACHE_LINE, sizeof(HashTable));
+
+  if (!table) {
+    fprintf(stderr, "Failed to allocate memory for hash table.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  table->buckets = malloc(sizeof(Entry *) * TABLE_SIZE);
+  if (!table->buckets) {
+    fprintf(stderr, "Failed to allocate memory for buckets.\n");
+    free(table);
+    exit(EXIT_FAILURE);
+  }
+
+  for (int i = 0; i < TABLE_SIZE; i++) {
+    atomic_init(&table->buckets[i], NULL);
+  }
+  for (int i = 0; i < SHARD_COUNT; i++) {
+    pthread_mutex_init(&table->shards[i].lock, NULL);
+  }
+
+  return table;
+}
+
+// Only safe once no other thread is using the table
+void free_table(HashTable *table) {
+  for (int i = 0; i < TABLE_SIZE; i++) {
+    Entry *entry = atomic_load_explicit(&table->buckets[i],
+                                        memory_order_relaxed);
+    while (entry != NULL) {
+      Entry *next = atomic_load_explicit(&entry->next, memory_order_relaxed);
+      free(entry);
+      entry = next;
+    }
+  }
+  for (int i = 0; i < SHARD_COUNT; i++) {
+    pthread_mutex_destroy(&table->shards[i].lock);
+  }
+  free(table->buckets);
+  free(table);
+}
+
+unsigned int hash(const char *key, size_t len) {
+  unsigned long int value = 0;
+  unsigned int i = 0;
+
+  for (; i < len; i++) {
+    value = value * 37 + key[i];
+  }
+
+  // Mix the high bits down so the low-bit bucket mask sees all of the key
+  value ^= value >> 16;
+  return value;
+}
+
+void thread_ctx_init(ThreadCtx *ctx, int id) {
+  ctx->slot = &epoch_slots[id];
+  ctx->retired = NULL;
+  ctx->retired_count = 0;
+  atomic_store(&ctx->slot->epoch, 0);
+}
+
+// Wait until everything this thread retired can be freed, then free it
+void thread_ctx_release(ThreadCtx *ctx) {
+  while (ctx->retired != NULL) {
+    try_reclaim(ctx);
+  }
+}
+
+static Entry *create_entry(const char *key, size_t len, unsigned int h,
+                           int value) {
+  Entry *new_entry = malloc(sizeof(Entry) + len + 1);
+  if (!new_entry) {
+    fprintf(stderr, "Failed to allocate memory for entry.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  memcpy(new_entry->key, key, len + 1);
+  new_entry->hash = h;
+  new_entry->len = len;
+  new_entry->value = value;
+  atomic_init(&new_entry->next, NULL);
+  new_entry->retired_next = NULL;
+
+  return new_entry;
+}
+
+// Announce the current epoch before touching any shared entry
+static void epoch_enter(ThreadCtx *ctx) {
+  atomic_store_explicit(&ctx->slot->epoch, atomic_load(&global_epoch),
+                        memory_order_relaxed);
+  // The announcement must be visible before we load any bucket pointer
+  atomic_thread_fence(memory_order_seq_cst);
+}
+
+static void epoch_exit(ThreadCtx *ctx) {
+  atomic_store_explicit(&ctx->slot->epoch, 0, memory_order_release);
+}
+
+// Advance the global epoch if every active thread has observed it
+static unsigned long try_advance_epoch(void) {
+  unsigned long epoch = atomic_load(&global_epoch);
+
+  for (int i = 0; i < MAX_THREADS; i++) {
+    unsigned long seen = atomic_load(&epoch_slots[i].epoch);
+    if (seen != 0 && seen != epoch) {
+      return epoch; // somebody is still in an older epoch
+    }
+  }
+  atomic_compare_exchange_strong(&global_epoch, &epoch, epoch + 1);
+  return atomic_load(&global_epoch);
+}
+
+static void retire(ThreadCtx *ctx, Entry *entry) {
+  entry->retire_epoch = atomic_load(&global_epoch);
+  entry->retired_next = ctx->retired;
+  ctx->retired = entry;
+
+  if (++ctx->retired_count % RETIRE_BATCH == 0) {
+    try_reclaim(ctx);
+  }
+}
+
+// Free every retired entry that is at least two epochs old
+static void try_reclaim(ThreadCtx *ctx) {
+  unsigned long epoch = try_advance_epoch();
+  Entry **link = &ctx->retired;
+
+  while (*link != NULL) {
+    Entry *entry = *link;
+    if (entry->retire_epoch + 2 <= epoch) {
+      *link = entry->retired_next;
+      free(entry);
+    } else {
+      link = &entry->retired_next;
+    }
+  }
+}
+
+void insert(HashTable *table, ThreadCtx *ctx, const char *key, int value) {
+  size_t len = strlen(key);
+  unsigned int h = hash(key, len);
+  unsigned int bucket = h & (TABLE_SIZE - 1);
+  Shard *shard = &table->shards[bucket % SHARD_COUNT];
+
+  Entry *new_entry = create_entry(key, len, h, value);
+  Entry *old = NULL;
+
+  pthread_mutex_lock(&shard->lock);
+
+  // Writers own the shard, so relaxed loads are enough to find the key
+  Entry *_Atomic *link = &table->buckets[bucket];
+  Entry *entry = atomic_load_explicit(link, memory_order_relaxed);
+  while (entry != NULL) {
+    if (entry->hash == h && entry->len == len &&
+        memcmp(entry->key, key, len) == 0) {
+      old = entry;
+      break;
+    }
+    link = &entry->next;
+    entry = atomic_load_explicit(link, memory_order_relaxed);
+  }
+
+  if (old != NULL) {
+    // Replace the entry in place in the chain
+    atomic_store_explicit(&new_entry->next,
+                          atomic_load_explicit(&old->next,
+                                               memory_order_relaxed),
+                          memory_order_relaxed);
+    atomic_store_explicit(link, new_entry, memory_order_release);
+  } else {
+    // Prepend, publishing the fully built entry with a release store
+    atomic_store_explicit(
+        &new_entry->next,
+        atomic_load_explicit(&table->buckets[bucket], memory_order_relaxed),
+        memory_order_relaxed);
+    atomic_store_explicit(&table->buckets[bucket], new_entry,
+                          memory_order_release);
+  }
+
+  pthread_mutex_unlock(&shard->lock);
+
+  if (old != NULL) {
+    retire(ctx, old);
+  }
+}
+
+int search(HashTable *table, ThreadCtx *ctx, const char *key, int *value) {
+  size_t len = strlen(key);
+  unsigned int h = hash(key, len);
+  int found = 0;
+
+  epoch_enter(ctx);
+
+  Entry *entry = atomic_load_explicit(&table->buckets[h & (TABLE_SIZE - 1)],
+                                      memory_order_acquire);
+  while (entry != NULL) {
+    if (entry->hash == h && entry->len == len &&
+        memcmp(entry->key, key, len) == 0) {
+      // Key found
+      *value = entry->value;
+      found = 1;
+      break;
+    }
+    entry = atomic_load_explicit(&entry->next, memory_order_acquire);
+  }
+
+  epoch_exit(ctx);
+
+  return found;
+}
+
+typedef struct {
+  HashTable *table;
+  int id;
+  unsigned long reads;
+  unsigned long writes;
+} Worker;
+
+// keys[i] is "key<i>", formatted once so the timed loop measures the map
+static char keys[KEY_SPACE][KEY_LEN];
+
+static void *worker_main(void *arg) {
+  Worker *worker = arg;
+  ThreadCtx ctx;
+  unsigned int seed = 12345u + worker->id * 7919u;
+  unsigned long reads = 0, writes = 0;
+  int value;
+
+  thread_ctx_init(&ctx, worker->id);
+
+  for (int i = 0; i < OPS_PER_THREAD; i++) {
+    seed = seed * 1103515245u + 12345u; // small LCG, cheaper than rand()
+    const char *key = keys[(seed >> 8) % KEY_SPACE];
+
+    if ((seed >> 4) % 100 < WRITE_PERCENT) {
+      insert(worker->table, &ctx, key, i);
+      writes++;
+    } else {
+      search(worker->table, &ctx, key, &value);
+      reads++;
+    }
+  }
+
+  // Counted locally: neighbouring Workers share a cache line
+  worker->reads = reads;
+  worker->writes = writes;
+  thread_ctx_release(&ctx);
+  return NULL;
+}
+
+void run_benchmark(int threads) {
+  HashTable *table = create_table();
+  ThreadCtx ctx;
+  pthread_t tids[MAX_THREADS];
+  Worker workers[MAX_THREADS];
+  struct timespec start, end;
+
+  // Pre-populate so reads mostly hit
+  thread_ctx_init(&ctx, 0);
+  for (int i = 0; i < KEY_SPACE; i++) {
+    snprintf(keys[i], KEY_LEN, "key%d", i);
+    insert(table, &ctx, keys[i], i);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < threads; i++) {
+    workers[i] = (Worker){table, i, 0, 0};
+    pthread_create(&tids[i], NULL, worker_main, &workers[i]);
+  }
+
+  unsigned long reads = 0, writes = 0;
+  for (int i = 0; i < threads; i++) {
+    pthread_join(tids[i], NULL);
+    reads += workers[i].reads;
+    writes += workers[i].writes;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double secs =
+      (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  printf("%7d  %12.0f  %12.0f\n", threads, reads / secs, writes / secs);
+
+  free_table(table);
+}
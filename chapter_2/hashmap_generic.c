@@ -0,0 +1,51 @@
+#include "hashmap_generic.h"
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct {
+  double x;
+  double y;
+} Point;
+
+// int64 -> Point and string -> double, each with its own inlined hash and eq
+DEFINE_HASHMAP(PointMap, int64_t, Point, hashmap_hash_i64, hashmap_eq_i64)
+DEFINE_HASHMAP(PriceMap, const char *, double, hashmap_hash_str,
+               hashmap_eq_str)
+
+int main(void) {
+  PointMap *points = PointMap_create(0);
+
+  for (int64_t id = 0; id < 1000; id++) {
+    PointMap_put(points, id * 1000003, (Point){id, -id});
+  }
+  PointMap_erase(points, 5 * 1000003);
+
+  Point *p = PointMap_get(points, 42 * 1000003);
+  if (p) {
+    printf("Point 42 is (%g, %g)\n", p->x, p->y);
+  }
+  printf("Point 5 %s\n", PointMap_get(points, 5 * 1000003) ? "found"
+                                                           : "was removed");
+  printf("%zu points stored\n", points->count);
+
+  PointMap_free(points);
+
+  PriceMap *prices = PriceMap_create(4);
+
+  PriceMap_put(prices, "apple", 1.25);
+  PriceMap_put(prices, "bread", 2.40);
+  PriceMap_put(prices, "milk", 0.99);
+  PriceMap_put(prices, "apple", 1.30); // update
+
+  // Walk every entry
+  size_t pos = 0;
+  const char *item;
+  double *price;
+  while (PriceMap_next(prices, &pos, &item, &price)) {
+    printf("%s costs %.2f\n", item, *price);
+  }
+
+  PriceMap_free(prices);
+
+  return 0;
+}
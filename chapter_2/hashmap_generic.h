@@ -0,0 +1,186 @@
+/*
+ * Type-specialized hash maps generated by a macro
+ *
+ *   DEFINE_HASHMAP(name, K, V, hash_fn, eq_fn)
+ *
+ * expands to a map type `name` from K to V together with the functions
+ *
+ *   name *name_create(size_t expected);
+ *   void name_free(name *map);
+ *   void name_put(name *map, K key, V value);   insert or update
+ *   V *name_get(const name *map, K key);        NULL if key is absent
+ *   int name_erase(name *map, K key);           1 if key was removed
+ *   int name_next(const name *map, size_t *pos, K *key, V **value);
+ *
+ * hash_fn is called as `unsigned int hash_fn(K key)` and eq_fn as
+ * `int eq_fn(K a, K b)`. Both are plain function (or macro) calls in the
+ * generated code, so the compiler can inline them for each instantiation;
+ * there is no void * and no callback through a function pointer.
+ *
+ * Unlike hashmap.c, entries live directly in one array (open addressing with
+ * linear probing) and a removed entry is filled by shifting the rest of its
+ * probe run back, so no tombstones are left behind. The map does not copy
+ * what pointer keys point to: a char * key must outlive its entry.
+ */
+#ifndef HASHMAP_GENERIC_H
+#define HASHMAP_GENERIC_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Ready-made hash and equality functions for common key types
+
+static inline unsigned int hashmap_hash_i64(int64_t key) {
+  uint64_t x = (uint64_t)key;
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  return (unsigned int)x;
+}
+
+static inline int hashmap_eq_i64(int64_t a, int64_t b) { return a == b; }
+
+static inline unsigned int hashmap_hash_str(const char *key) {
+  unsigned long int value = 0;
+
+  for (; *key != '\0'; key++) {
+    value = value * 37 + *key;
+  }
+
+  return value ^ (value >> 15);
+}
+
+static inline int hashmap_eq_str(const char *a, const char *b) {
+  return strcmp(a, b) == 0;
+}
+
+#define DEFINE_HASHMAP(name, K, V, hash_fn, eq_fn)                            \
+  typedef struct {                                                            \
+    K key;                                                                    \
+    V value;                                                                  \
+  } name##_slot;                                                              \
+                                                                              \
+  typedef struct {                                                            \
+    name##_slot *slots;                                                       \
+    unsigned char *used; /* 1 if the slot holds an entry */                   \
+    size_t capacity;     /* always a power of two */                          \
+    size_t count;                                                             \
+  } name;                                                                     \
+                                                                              \
+  static inline void name##_alloc_slots(name *map, size_t capacity) {         \
+    map->slots = malloc(sizeof(name##_slot) * capacity);                      \
+    map->used = calloc(capacity, 1);                                          \
+    if (!map->slots || !map->used) {                                          \
+      fprintf(stderr, "Failed to allocate memory for " #name ".\n");         \
+      exit(EXIT_FAILURE);                                                     \
+    }                                                                         \
+    map->capacity = capacity;                                                 \
+  }                                                                           \
+                                                                              \
+  /* Room for `expected` entries before the first resize */                  \
+  static inline name *name##_create(size_t expected) {                        \
+    name *map = malloc(sizeof(name));                                         \
+    size_t capacity = 8;                                                      \
+                                                                              \
+    if (!map) {                                                               \
+      fprintf(stderr, "Failed to allocate memory for " #name ".\n");         \
+      exit(EXIT_FAILURE);                                                     \
+    }                                                                         \
+    while (capacity * 3 / 4 < expected) {                                     \
+      capacity *= 2;                                                          \
+    }                                                                         \
+    name##_alloc_slots(map, capacity);                                        \
+    map->count = 0;                                                           \
+    return map;                                                               \
+  }                                                                           \
+                                                                              \
+  static inline void name##_free(name *map) {                                 \
+    free(map->slots);                                                         \
+    free(map->used);                                                          \
+    free(map);                                                                \
+  }                                                                           \
+                                                                              \
+  /* Index of key's slot, or of the empty slot that ends its probe run */     \
+  static inline size_t name##_find(const name *map, K key) {                  \
+    size_t mask = map->capacity - 1;                                          \
+    size_t i = hash_fn(key) & mask;                                           \
+                                                                              \
+    while (map->used[i] && !eq_fn(map->slots[i].key, key)) {                  \
+      i = (i + 1) & mask;                                                     \
+    }                                                                         \
+    return i;                                                                 \
+  }                                                                           \
+                                                                              \
+  static inline void name##_grow(name *map) {                                 \
+    name##_slot *old_slots = map->slots;                                      \
+    unsigned char *old_used = map->used;                                      \
+    size_t old_capacity = map->capacity;                                      \
+                                                                              \
+    name##_alloc_slots(map, old_capacity * 2);                                \
+    for (size_t j = 0; j < old_capacity; j++) {                               \
+      if (old_used[j]) {                                                      \
+        size_t i = name##_find(map, old_slots[j].key);                        \
+        map->slots[i] = old_slots[j];                                         \
+        map->used[i] = 1;                                                     \
+      }                                                                       \
+    }                                                                         \
+    free(old_slots);                                                          \
+    free(old_used);                                                           \
+  }                                                                           \
+                                                                              \
+  static inline void name##_put(name *map, K key, V value) {                  \
+    if ((map->count + 1) * 4 > map->capacity * 3) {                          \
+      name##_grow(map);                                                       \
+    }                                                                         \
+    size_t i = name##_find(map, key);                                         \
+    if (!map->used[i]) {                                                      \
+      map->slots[i].key = key;                                                \
+      map->used[i] = 1;                                                       \
+      map->count++;                                                           \
+    }                                                                         \
+    map->slots[i].value = value;                                              \
+  }                                                                           \
+                                                                              \
+  static inline V *name##_get(const name *map, K key) {                       \
+    size_t i = name##_find(map, key);                                         \
+    return map->used[i] ? &map->slots[i].value : NULL;                        \
+  }                                                                           \
+                                                                              \
+  /* Backward-shift deletion: pull later members of the run into the gap */   \
+  static inline int name##_erase(name *map, K key) {                          \
+    size_t mask = map->capacity - 1;                                          \
+    size_t gap = name##_find(map, key);                                       \
+                                                                              \
+    if (!map->used[gap]) {                                                    \
+      return 0;                                                               \
+    }                                                                         \
+    for (size_t i = (gap + 1) & mask; map->used[i]; i = (i + 1) & mask) {     \
+      size_t home = hash_fn(map->slots[i].key) & mask;                        \
+      /* Move i back unless its home lies cyclically in (gap, i] */           \
+      if (((i - home) & mask) >= ((i - gap) & mask)) {                        \
+        map->slots[gap] = map->slots[i];                                      \
+        gap = i;                                                              \
+      }                                                                       \
+    }                                                                         \
+    map->used[gap] = 0;                                                       \
+    map->count--;                                                             \
+    return 1;                                                                 \
+  }                                                                           \
+                                                                              \
+  /* Iterate: start with *pos = 0, returns 0 when there are no more entries */ \
+  static inline int name##_next(const name *map, size_t *pos, K *key,         \
+                                V **value) {                                  \
+    for (; *pos < map->capacity; (*pos)++) {                                  \
+      if (map->used[*pos]) {                                                  \
+        *key = map->slots[*pos].key;                                          \
+        *value = &map->slots[*pos].value;                                     \
+        (*pos)++;                                                             \
+        return 1;                                                             \
+      }                                                                       \
+    }                                                                         \
+    return 0;                                                                 \
+  }
+
+#endif
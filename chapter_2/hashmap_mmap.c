@@ -0,0 +1,366 @@
+/*
+ * Persistent, memory-mapped variant of hashmap.c
+ *
+ * A table is written once with write_table() and then mapped read-only by any
+ * number of processes with map_table(). Lookups run directly against the
+ * mapping: nothing is copied or rebuilt at startup, and all processes share
+ * the same page-cache pages.
+ *
+ * The file holds no pointers, only offsets from the start of the file, so it
+ * can be mapped at any address. Integers are stored in host byte order.
+ *
+ *   Header
+ *   uint32_t bucket_starts[bucket_count + 1]  first entry of each bucket
+ *   DiskEntry entries[entry_count]            grouped by bucket
+ *   char keys[]                               '\0'-terminated key bytes
+ *
+ * Usage: ./a.out FILE [KEY...]   write a demo table to FILE (if no keys are
+ *                                given) or look KEYs up in an existing one
+ */
+#define _XOPEN_SOURCE 600 // for mkstemp() and fsync()
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TABLE_MAGIC "HMAPv1\0"
+
+typedef struct {
+  char magic[8];
+  uint32_t bucket_count;
+  uint32_t entry_count;
+  uint64_t buckets_off; // offset of bucket_starts[]
+  uint64_t entries_off; // offset of entries[]
+  uint64_t keys_off;    // offset of the key bytes
+  uint64_t file_size;
+} Header;
+
+typedef struct {
+  uint32_t hash;
+  uint32_t len;     // key length, not counting the '\0'
+  uint32_t key_off; // offset of the key from keys_off
+  int32_t value;
+} DiskEntry;
+
+typedef struct {
+  const unsigned char *base; // start of the mapping
+  size_t size;
+  const Header *header;
+  const uint32_t *bucket_starts;
+  const DiskEntry *entries;
+  const char *keys;
+  uint64_t keys_size; // bytes from keys to the end of the file
+} MappedTable;
+
+unsigned int hash(const char *key, size_t len);
+int write_table(const char *path, const char *keys[], const int values[],
+                size_t n);
+MappedTable *map_table(const char *path);
+void unmap_table(MappedTable *table);
+int search(const MappedTable *table, const char *key, int *value);
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s FILE [KEY...]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (argc == 2) {
+    const char *names[] = {"Alice", "Bob", "Seyfi", "Leyli",
+                           "Maximilian-Alexander"};
+    const int ages[] = {25, 30, 59, 54, 41};
+
+    if (write_table(argv[1], names, ages, 5) != 0) {
+      return EXIT_FAILURE;
+    }
+    printf("Wrote %s\n", argv[1]);
+    return 0;
+  }
+
+  MappedTable *table = map_table(argv[1]);
+  if (!table) {
+    return EXIT_FAILURE;
+  }
+
+  for (int i = 2; i < argc; i++) {
+    int age;
+    if (search(table, argv[i], &age)) {
+      printf("%s's age is: %d\n", argv[i], age);
+    } else {
+      printf("%s was not found\n", argv[i]);
+    }
+  }
+
+  unmap_table(table);
+  return 0;
+}
+
+unsigned int hash(const char *key, size_t len) {
+  unsigned long int value = 0;
+  unsigned int i = 0;
+
+  for (; i < len; i++) {
+    value = value * 37 + key[i];
+  }
+
+  return value;
+}
+
+static int write_all(FILE *fp, const void *data, size_t size) {
+  return fwrite(data, 1, size, fp) == size ? 0 : -1;
+}
+
+/*
+ * Write n key/value pairs to path. The table is written to a uniquely named
+ * temporary file next to path, synced to disk and renamed over path at the
+ * end, so readers never map a half-written table and concurrent writers do
+ * not clobber each other's temporary files. If a key repeats, the last value
+ * wins. Returns 0 on success and -1 (with a message on stderr) on failure.
+ */
+int write_table(const char *path, const char *keys[], const int values[],
+                size_t n) {
+  uint32_t bucket_count = n + n / 3 + 1;
+  uint32_t *bucket_starts = calloc(bucket_count + 1, sizeof(uint32_t));
+  uint32_t *order = malloc(sizeof(uint32_t) * (n ? n : 1));
+  DiskEntry *entries = malloc(sizeof(DiskEntry) * (n ? n : 1));
+  uint32_t *hashes = malloc(sizeof(uint32_t) * (n ? n : 1));
+
+  if (!bucket_starts || !order || !entries || !hashes) {
+    fprintf(stderr, "Failed to allocate memory for table image.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Count keys per bucket, then turn the counts into start offsets
+  for (size_t i = 0; i < n; i++) {
+    hashes[i] = hash(keys[i], strlen(keys[i]));
+    bucket_starts[hashes[i] % bucket_count + 1]++;
+  }
+  for (uint32_t b = 0; b < bucket_count; b++) {
+    bucket_starts[b + 1] += bucket_starts[b];
+  }
+
+  // Place key indices bucket by bucket, keeping the input order in each
+  uint32_t *cursor = malloc(sizeof(uint32_t) * bucket_count);
+  if (!cursor) {
+    fprintf(stderr, "Failed to allocate memory for table image.\n");
+    exit(EXIT_FAILURE);
+  }
+  memcpy(cursor, bucket_starts, sizeof(uint32_t) * bucket_count);
+  for (size_t i = 0; i < n; i++) {
+    order[cursor[hashes[i] % bucket_count]++] = i;
+  }
+  free(cursor);
+
+  // Fold repeated keys into their first slot and compact each bucket
+  uint32_t entry_count = 0;
+  uint64_t key_bytes = 0;
+  for (uint32_t b = 0; b < bucket_count; b++) {
+    uint32_t first = entry_count;
+
+    for (uint32_t j = bucket_starts[b]; j < bucket_starts[b + 1]; j++) {
+      uint32_t i = order[j];
+      uint32_t len = strlen(keys[i]);
+      uint32_t k = first;
+
+      while (k < entry_count &&
+             !(entries[k].hash == hashes[i] && entries[k].len == len &&
+               memcmp(keys[order[entries[k].key_off]], keys[i], len) == 0)) {
+        k++;
+      }
+      if (k < entry_count) {
+        entries[k].value = values[i]; // later pair wins
+        continue;
+      }
+
+      // key_off temporarily holds the position in order[] of the key
+      entries[entry_count++] = (DiskEntry){hashes[i], len, j, values[i]};
+    }
+    bucket_starts[b] = first;
+  }
+  bucket_starts[bucket_count] = entry_count;
+
+  for (uint32_t k = 0; k < entry_count; k++) {
+    uint32_t i = order[entries[k].key_off];
+    entries[k].key_off = key_bytes;
+    key_bytes += entries[k].len + 1;
+    order[k] = i; // k <= the old position, so this never clobbers a live slot
+  }
+
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, TABLE_MAGIC, sizeof(header.magic));
+  header.bucket_count = bucket_count;
+  header.entry_count = entry_count;
+  header.buckets_off = sizeof(Header);
+  header.entries_off =
+      header.buckets_off + sizeof(uint32_t) * ((uint64_t)bucket_count + 1);
+  header.entries_off = (header.entries_off + 15) & ~(uint64_t)15;
+  header.keys_off = header.entries_off + sizeof(DiskEntry) * entry_count;
+  header.file_size = header.keys_off + key_bytes;
+
+  char tmp_path[4096];
+  snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+  int fd = mkstemp(tmp_path);
+  FILE *fp = NULL;
+  int status = -1;
+
+  // mkstemp() creates the file 0600; the table is meant to be shared
+  if (fd < 0) {
+    perror(tmp_path);
+  } else if (fchmod(fd, 0644) != 0 || !(fp = fdopen(fd, "wb"))) {
+    perror(tmp_path);
+    close(fd);
+    remove(tmp_path);
+  } else {
+    static const char zeros[16];
+    uint64_t pad = header.entries_off - header.buckets_off -
+                   sizeof(uint32_t) * ((uint64_t)bucket_count + 1);
+
+    status = write_all(fp, &header, sizeof(header));
+    status |= write_all(fp, bucket_starts,
+                        sizeof(uint32_t) * ((size_t)bucket_count + 1));
+    status |= write_all(fp, zeros, pad);
+    status |= write_all(fp, entries, sizeof(DiskEntry) * entry_count);
+    for (uint32_t k = 0; k < entry_count; k++) {
+      status |= write_all(fp, keys[order[k]], entries[k].len + 1);
+    }
+    // Data must be on disk before the rename makes it visible as path
+    if (fflush(fp) != 0 || fsync(fileno(fp)) != 0) {
+      status = -1;
+    }
+    if (fclose(fp) != 0) {
+      status = -1;
+    }
+    if (status == 0 && rename(tmp_path, path) != 0) {
+      status = -1;
+    }
+    if (status != 0) {
+      perror(path);
+      remove(tmp_path);
+    }
+  }
+
+  free(hashes);
+  free(entries);
+  free(order);
+  free(bucket_starts);
+  return status;
+}
+
+/*
+ * Map a table written by write_table() read-only. The header is checked so a
+ * truncated or foreign file is rejected instead of read out of bounds: every
+ * section must lie inside the file, in order, and be aligned for its type.
+ * The bucket starts and entries are checked by search() as it reads them,
+ * so mapping stays O(1) however large the table is. Returns NULL (with a
+ * message on stderr) on failure.
+ */
+MappedTable *map_table(const char *path) {
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    perror(path);
+    if (fd >= 0) {
+      close(fd);
+    }
+    return NULL;
+  }
+
+  if ((size_t)st.st_size < sizeof(Header)) {
+    fprintf(stderr, "%s: not a hash table file\n", path);
+    close(fd);
+    return NULL;
+  }
+
+  void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping keeps the file alive
+  if (base == MAP_FAILED) {
+    perror(path);
+    return NULL;
+  }
+
+  // Offsets are compared with the file size first, so the sums below cannot
+  // overflow
+  const Header *header = base;
+  if (memcmp(header->magic, TABLE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->file_size != (uint64_t)st.st_size ||
+      header->bucket_count == 0 || header->buckets_off < sizeof(Header) ||
+      header->buckets_off > header->file_size ||
+      header->entries_off > header->file_size ||
+      header->keys_off > header->file_size ||
+      header->buckets_off % sizeof(uint32_t) != 0 ||
+      header->entries_off % sizeof(uint32_t) != 0 ||
+      header->buckets_off +
+              sizeof(uint32_t) * ((uint64_t)header->bucket_count + 1) >
+          header->entries_off ||
+      header->entries_off + sizeof(DiskEntry) * (uint64_t)header->entry_count >
+          header->keys_off) {
+    fprintf(stderr, "%s: corrupt hash table file\n", path);
+    munmap(base, st.st_size);
+    return NULL;
+  }
+
+  MappedTable *table = malloc(sizeof(MappedTable));
+  if (!table) {
+    fprintf(stderr, "Failed to allocate memory for mapped table.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  table->base = base;
+  table->size = st.st_size;
+  table->header = header;
+  table->bucket_starts =
+      (const uint32_t *)(table->base + header->buckets_off);
+  table->entries = (const DiskEntry *)(table->base + header->entries_off);
+  table->keys = (const char *)(table->base + header->keys_off);
+  table->keys_size = header->file_size - header->keys_off;
+
+  if (table->bucket_starts[header->bucket_count] != header->entry_count) {
+    fprintf(stderr, "%s: corrupt hash table file\n", path);
+    unmap_table(table);
+    return NULL;
+  }
+
+  return table;
+}
+
+void unmap_table(MappedTable *table) {
+  munmap((void *)table->base, table->size);
+  free(table);
+}
+
+int search(const MappedTable *table, const char *key, int *value) {
+  size_t len = strlen(key);
+  unsigned int h = hash(key, len);
+  uint32_t bucket = h % table->header->bucket_count;
+  uint32_t first = table->bucket_starts[bucket];
+  uint32_t last = table->bucket_starts[bucket + 1];
+
+  // The file may be corrupt: a bucket out of order or past the entries is
+  // treated as empty
+  if (first > last || last > table->header->entry_count) {
+    return 0;
+  }
+
+  // A bucket is a run of neighbouring entries, so this scan is sequential
+  const DiskEntry *entry = &table->entries[first];
+  const DiskEntry *end = &table->entries[last];
+  for (; entry < end; entry++) {
+    if (entry->hash == h && entry->len == len &&
+        entry->key_off < table->keys_size &&
+        len < table->keys_size - entry->key_off && // key and its '\0' fit
+        memcmp(table->keys + entry->key_off, key, len) == 0) {
+      // Key found
+      *value = entry->value;
+      return 1;
+    }
+  }
+
+  // Key not found
+  return 0;
+}
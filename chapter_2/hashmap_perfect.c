@@ -0,0 +1,391 @@
+/*
+ * Perfect-hash variant of hashmap.c for key sets that never change
+ *
+ * build_perfect_table() takes a fixed list of keys and computes a minimal
+ * perfect hash for it with the CHD (compress, hash and displace) scheme:
+ *
+ *   - every key is hashed into one of n / KEYS_PER_BUCKET buckets;
+ *   - buckets are processed largest first, and for each one we search for a
+ *     displacement d such that slot(key, d) sends all of its keys to slots
+ *     that are still free;
+ *   - only d is stored per bucket. Buckets holding a single key are placed
+ *     last and simply take a free slot, whose index is stored as d with the
+ *     DIRECT_SLOT bit set.
+ *
+ * The frozen table has exactly n slots for n keys, so there are no empty
+ * slots, and a lookup reads one displacement and then probes exactly one
+ * slot. The key stored there is compared so absent keys are still rejected.
+ *
+ * Usage: ./a.out [N]   run the demo, or build and time a table of N keys
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define KEYS_PER_BUCKET 4         // average bucket size; higher is smaller
+#define MAX_SEEDS 32              // give up after this many hash seeds
+#define MAX_DISPLACEMENT 1000000u // tried per bucket before a new seed
+#define DIRECT_SLOT 0x80000000u   // displacement flag: the rest is the slot
+
+typedef struct {
+  const char *key; // points into the table's key arena
+  unsigned int len;
+  int value;
+} Slot;
+
+typedef struct {
+  uint32_t size;     // number of keys, and of slots
+  uint32_t buckets;  // number of displacement entries
+  uint64_t seed;
+  uint32_t *displacements;
+  Slot *slots;
+  char *key_arena;
+} PerfectTable;
+
+uint64_t hash(const char *key, size_t len, uint64_t seed);
+PerfectTable *build_perfect_table(const char *keys[], const int values[],
+                                  size_t n);
+void free_perfect_table(PerfectTable *table);
+int search(const PerfectTable *table, const char *key, int *value);
+void benchmark(size_t n);
+
+int main(int argc, char *argv[]) {
+  if (argc > 1) {
+    benchmark(strtoul(argv[1], NULL, 10));
+    return 0;
+  }
+
+  const char *names[] = {"Alice", "Bob",   "Seyfi", "Leyli",
+                         "Can",   "Deniz", "Ece",   "Fatma-Nur-Gulsen"};
+  const int ages[] = {25, 30, 59, 54, 31, 28, 35, 62};
+  PerfectTable *table = build_perfect_table(names, ages, 8);
+
+  if (!table) {
+    return EXIT_FAILURE;
+  }
+
+  const char *wanted[] = {"Leyli", "Can", "Zeynep"};
+  for (int i = 0; i < 3; i++) {
+    int age;
+    if (search(table, wanted[i], &age)) {
+      printf("%s's age is: %d\n", wanted[i], age);
+    } else {
+      printf("%s was not found\n", wanted[i]);
+    }
+  }
+
+  for (uint32_t i = 0; i < table->size; i++) {
+    printf("Slot[%u]: (%s: %d)\n", i, table->slots[i].key,
+           table->slots[i].value);
+  }
+
+  free_perfect_table(table);
+  return 0;
+}
+
+/*
+ * Seeded 64-bit FNV-1a with a final avalanche step. CHD needs independent
+ * looking hashes for each seed, which the multiply-by-37 hash in hashmap.c
+ * does not give.
+ */
+uint64_t hash(const char *key, size_t len, uint64_t seed) {
+  uint64_t value = 0xcbf29ce484222325ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+
+  for (size_t i = 0; i < len; i++) {
+    value ^= (unsigned char)key[i];
+    value *= 0x100000001b3ULL;
+  }
+
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+
+// Slot of a key with hash h under displacement d
+static uint32_t slot_of(uint64_t h, uint32_t d, uint32_t size) {
+  if (d & DIRECT_SLOT) {
+    return d & ~DIRECT_SLOT;
+  }
+
+  // Every d gives the bucket's keys a fresh, independent set of slots
+  h ^= (d + 1) * 0x9e3779b97f4a7c15ULL;
+  h ^= h >> 29;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 32;
+  return (uint32_t)(((h & 0xffffffffu) * size) >> 32);
+}
+
+static uint32_t bucket_of(uint64_t h, uint32_t buckets) {
+  // Use different bits than slot_of() so the two choices are independent
+  return (uint32_t)((h * 0x9e3779b97f4a7c15ULL) >> 32) % buckets;
+}
+
+static const uint32_t *sort_starts; // bucket start offsets, for sorting
+
+static int compare_buckets(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  uint32_t size_x = sort_starts[x + 1] - sort_starts[x];
+  uint32_t size_y = sort_starts[y + 1] - sort_starts[y];
+  return (size_x < size_y) - (size_x > size_y); // largest first
+}
+
+/*
+ * Try to place every key with the given seed. Fills displacements[] and
+ * order[] (key index held by each slot) and returns 1 on success, 0 if some
+ * bucket could not be placed, and -1 if the key list holds a duplicate.
+ */
+static int place_keys(const char *keys[], const size_t lens[], size_t n,
+                      uint64_t seed, uint32_t buckets,
+                      uint32_t *displacements, uint32_t *order) {
+  uint64_t *hashes = malloc(sizeof(uint64_t) * n);
+  uint32_t *starts = calloc(buckets + 1, sizeof(uint32_t));
+  uint32_t *cursor = malloc(sizeof(uint32_t) * buckets);
+  uint32_t *members = malloc(sizeof(uint32_t) * n);
+  uint32_t *by_size = malloc(sizeof(uint32_t) * buckets);
+  unsigned char *taken = calloc(n, 1);
+  uint32_t positions[64];
+  uint32_t next_free = 0; // no slot below this is free
+  int status = 1;
+
+  if (!hashes || !starts || !cursor || !members || !by_size || !taken) {
+    fprintf(stderr, "Failed to allocate memory for perfect hash build.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Group the key indices by bucket
+  for (size_t i = 0; i < n; i++) {
+    hashes[i] = hash(keys[i], lens[i], seed);
+    starts[bucket_of(hashes[i], buckets) + 1]++;
+  }
+  for (uint32_t b = 0; b < buckets; b++) {
+    starts[b + 1] += starts[b];
+    cursor[b] = starts[b];
+    by_size[b] = b;
+  }
+  for (size_t i = 0; i < n; i++) {
+    members[cursor[bucket_of(hashes[i], buckets)]++] = i;
+  }
+
+  sort_starts = starts;
+  qsort(by_size, buckets, sizeof(uint32_t), compare_buckets);
+
+  for (uint32_t k = 0; k < buckets && status == 1; k++) {
+    uint32_t b = by_size[k];
+    uint32_t count = starts[b + 1] - starts[b];
+    const uint32_t *keys_in_bucket = &members[starts[b]];
+
+    displacements[b] = 0;
+    if (count == 0) {
+      continue;
+    }
+    if (count > 64) {
+      status = 0; // hopelessly unbalanced seed
+      break;
+    }
+
+    // Two keys with the same 64-bit hash can never be separated
+    for (uint32_t i = 0; i < count; i++) {
+      for (uint32_t j = i + 1; j < count; j++) {
+        uint32_t a = keys_in_bucket[i], c = keys_in_bucket[j];
+        if (hashes[a] == hashes[c]) {
+          if (lens[a] == lens[c] && memcmp(keys[a], keys[c], lens[a]) == 0) {
+            fprintf(stderr, "Duplicate key: %s\n", keys[a]);
+            status = -1;
+          } else {
+            status = 0;
+          }
+        }
+      }
+    }
+
+    uint32_t d = 0;
+    if (count == 1) {
+      // Single keys come last and can take any free slot directly
+      while (taken[next_free]) {
+        next_free++;
+      }
+      d = DIRECT_SLOT | next_free;
+      positions[0] = next_free;
+      taken[next_free] = 1;
+    } else {
+      for (; status == 1 && d < MAX_DISPLACEMENT; d++) {
+        uint32_t i;
+        for (i = 0; i < count; i++) {
+          positions[i] = slot_of(hashes[keys_in_bucket[i]], d, n);
+          if (taken[positions[i]]) {
+            break;
+          }
+          taken[positions[i]] = 1; // claimed now to catch clashes in bucket
+        }
+        if (i == count) {
+          break;
+        }
+        while (i-- > 0) {
+          taken[positions[i]] = 0; // roll back this attempt
+        }
+      }
+      if (status == 1 && d == MAX_DISPLACEMENT) {
+        status = 0;
+      }
+    }
+
+    if (status == 1) {
+      displacements[b] = d;
+      for (uint32_t i = 0; i < count; i++) {
+        order[positions[i]] = keys_in_bucket[i];
+      }
+    }
+  }
+
+  free(taken);
+  free(by_size);
+  free(members);
+  free(cursor);
+  free(starts);
+  free(hashes);
+  return status;
+}
+
+/*
+ * Build a frozen table over n distinct keys. Returns NULL (with a message on
+ * stderr) if the key list contains a duplicate or no seed worked.
+ */
+PerfectTable *build_perfect_table(const char *keys[], const int values[],
+                                  size_t n) {
+  if (n == 0 || n > DIRECT_SLOT) {
+    fprintf(stderr, "Perfect tables need between 1 and %u keys.\n",
+            DIRECT_SLOT);
+    return NULL;
+  }
+
+  PerfectTable *table = malloc(sizeof(PerfectTable));
+  size_t *lens = malloc(sizeof(size_t) * n);
+  uint32_t *order = malloc(sizeof(uint32_t) * n);
+  size_t arena_size = 0;
+
+  if (!table || !lens || !order) {
+    fprintf(stderr, "Failed to allocate memory for perfect table.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    lens[i] = strlen(keys[i]);
+    arena_size += lens[i] + 1;
+  }
+
+  table->size = n;
+  table->buckets = (n + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET;
+  table->displacements = malloc(sizeof(uint32_t) * table->buckets);
+  table->slots = malloc(sizeof(Slot) * n);
+  table->key_arena = malloc(arena_size);
+  if (!table->displacements || !table->slots || !table->key_arena) {
+    fprintf(stderr, "Failed to allocate memory for perfect table.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  int status = 0;
+  for (table->seed = 1; table->seed <= MAX_SEEDS && status == 0;
+       table->seed++) {
+    status = place_keys(keys, lens, n, table->seed, table->buckets,
+                        table->displacements, order);
+  }
+  table->seed--; // undo the loop's last increment
+
+  if (status != 1) {
+    if (status == 0) {
+      fprintf(stderr, "No perfect hash found after %d seeds.\n", MAX_SEEDS);
+    }
+    free(order);
+    free(lens);
+    free_perfect_table(table);
+    return NULL;
+  }
+
+  // Lay the keys out in slot order so neighbouring slots share cache lines
+  char *arena = table->key_arena;
+  for (uint32_t s = 0; s < n; s++) {
+    uint32_t i = order[s];
+    memcpy(arena, keys[i], lens[i] + 1);
+    table->slots[s] = (Slot){arena, lens[i], values[i]};
+    arena += lens[i] + 1;
+  }
+
+  free(order);
+  free(lens);
+  return table;
+}
+
+void free_perfect_table(PerfectTable *table) {
+  free(table->displacements);
+  free(table->slots);
+  free(table->key_arena);
+  free(table);
+}
+
+int search(const PerfectTable *table, const char *key, int *value) {
+  size_t len = strlen(key);
+  uint64_t h = hash(key, len, table->seed);
+  uint32_t d = table->displacements[bucket_of(h, table->buckets)];
+  const Slot *slot = &table->slots[slot_of(h, d, table->size)];
+
+  // Exactly one slot to check; it holds key or key is not in the table
+  if (slot->len == len && memcmp(slot->key, key, len) == 0) {
+    *value = slot->value;
+    return 1;
+  }
+  return 0;
+}
+
+static double elapsed(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void benchmark(size_t n) {
+  const char **keys = malloc(sizeof(char *) * n);
+  int *values = malloc(sizeof(int) * n);
+  char *key_text = malloc(n * 24);
+  struct timespec start;
+
+  if (!keys || !values || !key_text) {
+    fprintf(stderr, "Failed to allocate memory for benchmark keys.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    snprintf(key_text + i * 24, 24, "user:%u", (unsigned int)i);
+    keys[i] = key_text + i * 24;
+    values[i] = (int)i;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  PerfectTable *table = build_perfect_table(keys, values, n);
+  double build_secs = elapsed(&start);
+  if (!table) {
+    exit(EXIT_FAILURE);
+  }
+
+  size_t hits = 0;
+  int value;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t i = n; i-- > 0;) {
+    hits += search(table, keys[i], &value) && value == (int)i;
+  }
+  double search_secs = elapsed(&start);
+
+  printf("%zu keys: built in %.3f s (seed %llu, %.2f bits of displacement "
+         "per key), %.1f ns per lookup, %zu/%zu found\n",
+         n, build_secs, (unsigned long long)table->seed,
+         32.0 * table->buckets / n, search_secs * 1e9 / n, hits, n);
+
+  free_perfect_table(table);
+  free(key_text);
+  free(values);
+  free(keys);
+}
@@ -1,5 +1,11 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SLAB_SIZE 4096 // bytes per block of nodes, one page
+#define CACHE_LINE 64  // bytes per unrolled node
+#define SKIP_MAX_LEVEL 16 // enough for about 4^16 values at p = 1/4
 
 // Define the structure for a node in the linked list
 typedef struct Node {
@@ -7,13 +13,103 @@ typedef struct Node {
   struct Node *next; // Pointer to the next node
 } Node;
 
+// A page-sized block of nodes handed out by the node pool
+typedef struct Slab {
+  struct Slab *next; // Previously allocated slab
+  Node nodes[];      // As many nodes as fit in the rest of the page
+} Slab;
+
+#define NODES_PER_SLAB ((SLAB_SIZE - sizeof(Slab)) / sizeof(Node))
+
+// A handle for a list that keeps track of both ends and the length, so
+// appending does not have to walk the list
+typedef struct {
+  Node *head;  // First node, NULL when empty
+  Node *tail;  // Last node, NULL when empty
+  size_t size; // Number of nodes
+} List;
+
+// A node of an unrolled list: one cache line holding several values
+typedef struct UnrolledNode {
+  struct UnrolledNode *next; // Pointer to the next node
+  int count;                 // Values in use, always at the front
+  int values[(CACHE_LINE - sizeof(struct UnrolledNode *) - sizeof(int)) /
+             sizeof(int)];
+} UnrolledNode;
+
+#define UNROLLED_CAPACITY                                                      \
+  ((int)(sizeof(((UnrolledNode *)0)->values) / sizeof(int)))
+
+typedef struct {
+  UnrolledNode *head;
+  UnrolledNode *tail;
+  size_t size; // Number of values
+} UnrolledList;
+
+// A skip list node is a Node with a tower of extra forward links on top.
+// Level 0 is node.next, so the bottom level is an ordinary sorted Node list.
+typedef struct SkipNode {
+  Node node;                  // Data and the level 0 link
+  int height;                 // Number of levels this node is linked into
+  struct SkipNode *forward[]; // Links for levels 1 .. height - 1
+} SkipNode;
+
+typedef struct {
+  SkipNode *head; // Sentinel with a full-height tower
+  int level;      // Levels currently in use
+  size_t size;    // Number of values
+} SkipList;
+
+// Slab of raw memory that skip list towers are carved from
+typedef struct TowerSlab {
+  struct TowerSlab *next; // Previously allocated slab
+} TowerSlab;
+
+// External variables: the pool every node of every list comes from
+static Slab *slabs = NULL;      // All slabs allocated so far
+static size_t slab_used = 0;    // Nodes handed out from the newest slab
+static Node *free_nodes = NULL; // Recycled nodes, linked through next
+
+// Function to take a node from the pool, allocating a new slab if needed
+Node *alloc_node(void) {
+  if (free_nodes != NULL) {
+    Node *node = free_nodes; // Reuse a recycled node first
+    free_nodes = node->next;
+    return node;
+  }
+  if (slabs == NULL || slab_used == NODES_PER_SLAB) {
+    Slab *slab = (Slab *)malloc(SLAB_SIZE);
+    if (slab == NULL) {
+      fprintf(stderr, "Memory allocation failed!\n");
+      exit(EXIT_FAILURE);
+    }
+    slab->next = slabs;
+    slabs = slab;
+    slab_used = 0;
+  }
+  return &slabs->nodes[slab_used++];
+}
+
+// Function to give a node back to the pool for reuse
+void release_node(Node *node) {
+  node->next = free_nodes;
+  free_nodes = node;
+}
+
+// Release every slab at once; all nodes from the pool become invalid
+void destroy_pool(void) {
+  while (slabs != NULL) {
+    Slab *next = slabs->next;
+    free(slabs);
+    slabs = next;
+  }
+  slab_used = 0;
+  free_nodes = NULL;
+}
+
 // Function to create a new node
 Node *create_node(int data) {
-  Node *new_node = (Node *)malloc(sizeof(Node));
-  if (new_node == NULL) {
-    fprintf(stderr, "Memory allocation failed!\n");
-    exit(EXIT_FAILURE);
-  }
+  Node *new_node = alloc_node();
   new_node->data = data; // Set the data for the new node
   new_node->next = NULL; // Initialize the next pointer to NULL
   return new_node;
@@ -63,7 +159,7 @@ void remove_node(Node **head, int data) {
     previous->next = current->next;
   }
 
-  free(current); // Free the memory allocated to the deleted node
+  release_node(current); // Return the deleted node to the pool
 }
 
 // Function to print the linked list
@@ -76,17 +172,742 @@ void print_list(Node *head) {
   printf("NULL\n");
 }
 
-// Free all nodes in the linked list
+// Free all nodes in the linked list by splicing them onto the pool's free
+// list in one go
 void free_list(Node *head) {
-  Node *current = head;
+  if (head == NULL) {
+    return;
+  }
+  Node *tail = head;
+  while (tail->next != NULL) {
+    tail = tail->next; // Find the last node
+  }
+  tail->next = free_nodes;
+  free_nodes = head;
+}
+
+// Function to remove every node whose data satisfies pred, in one pass.
+// The removed nodes are collected into a chain and handed back to the pool
+// with a single splice. Returns the number of nodes removed; if last is not
+// NULL it receives the last node left in the list.
+size_t remove_if(Node **head, int (*pred)(int data, void *arg), void *arg,
+                 Node **last) {
+  Node **link = head;       // Link that points at the current node
+  Node *kept = NULL;        // Last node kept so far
+  Node *removed = NULL;     // Chain of removed nodes
+  Node *removed_tail = NULL;
+  size_t count = 0;
+
+  while (*link != NULL) {
+    Node *current = *link;
+    if (pred(current->data, arg)) {
+      *link = current->next; // Bypass the node, link stays where it is
+      current->next = removed;
+      if (removed == NULL) {
+        removed_tail = current;
+      }
+      removed = current;
+      count++;
+    } else {
+      kept = current;
+      link = &current->next;
+    }
+  }
+
+  if (removed != NULL) {
+    removed_tail->next = free_nodes; // Give them all back at once
+    free_nodes = removed;
+  }
+  if (last != NULL) {
+    *last = kept;
+  }
+  return count;
+}
+
+// A small open-addressing set of ints, used to test membership in O(1)
+typedef struct {
+  int *values;
+  unsigned char *used;
+  size_t mask; // Capacity - 1, capacity is a power of two
+} IntSet;
+
+static size_t int_hash(int value, size_t mask) {
+  return ((unsigned int)value * 2654435761u) & mask;
+}
+
+static void int_set_init(IntSet *set, const int values[], size_t n) {
+  size_t capacity = 8;
+  while (capacity < 2 * n) {
+    capacity *= 2; // Keep the set at most half full
+  }
+  set->values = malloc(capacity * sizeof(int));
+  set->used = calloc(capacity, 1);
+  if (set->values == NULL || set->used == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+  set->mask = capacity - 1;
+
+  for (size_t i = 0; i < n; i++) {
+    size_t slot = int_hash(values[i], set->mask);
+    while (set->used[slot] && set->values[slot] != values[i]) {
+      slot = (slot + 1) & set->mask;
+    }
+    set->values[slot] = values[i];
+    set->used[slot] = 1;
+  }
+}
+
+static int int_set_contains(const IntSet *set, int value) {
+  size_t slot = int_hash(value, set->mask);
+  while (set->used[slot]) {
+    if (set->values[slot] == value) {
+      return 1;
+    }
+    slot = (slot + 1) & set->mask;
+  }
+  return 0;
+}
+
+static int in_set(int data, void *arg) { return int_set_contains(arg, data); }
+
+// Function to remove every node whose data is one of values[0..n-1] in a
+// single traversal, instead of one remove_node() scan per value. last is as
+// for remove_if().
+size_t remove_values(Node **head, const int values[], size_t n, Node **last) {
+  IntSet set;
+  int_set_init(&set, values, n);
+  size_t count = remove_if(head, in_set, &set, last);
+  free(set.values);
+  free(set.used);
+  return count;
+}
+
+// Merge two sorted chains into one; on equal data a's node comes first, which
+// keeps the sort stable. If tail is not NULL it receives the last node.
+static Node *merge(Node *a, Node *b, Node **tail) {
+  Node merged;
+  Node *last = &merged;
+
+  while (a != NULL && b != NULL) {
+    if (b->data < a->data) {
+      last->next = b;
+      b = b->next;
+    } else {
+      last->next = a;
+      a = a->next;
+    }
+    last = last->next;
+  }
+  last->next = a != NULL ? a : b;
+
+  if (tail != NULL) {
+    while (last->next != NULL) {
+      last = last->next;
+    }
+    *tail = last;
+  }
+  return merged.next;
+}
+
+// Function to sort a list by data, stably, by relinking its nodes. Nothing is
+// allocated: runs[k] holds a sorted run of 2^k nodes, and adding a node merges
+// equal-sized runs the way adding 1 to a binary counter carries, so every
+// merge works on runs built recently and still in the cache. Returns the last
+// node.
+Node *sort_list(Node **head) {
+  Node *runs[64] = {NULL}; // runs[k] has 2^k nodes or is empty
+  Node *current = *head;
+  Node *tail = NULL;
+  int levels = 0;
+
   while (current != NULL) {
-    Node *next_node = current->next; // Store the next node
-    free(current);                   // Free the current node
-    current = next_node;             // Move to the next node
+    Node *run = current;
+    current = current->next;
+    run->next = NULL;
+
+    int k = 0;
+    for (; runs[k] != NULL; k++) {
+      run = merge(runs[k], run, NULL); // runs[k] holds the earlier nodes
+      runs[k] = NULL;
+    }
+    runs[k] = run;
+    if (k >= levels) {
+      levels = k + 1;
+    }
+  }
+
+  // Merge the leftover runs, from the latest (smallest) to the earliest; the
+  // largest run is always present and comes last
+  Node *sorted = NULL;
+  for (int k = 0; k < levels; k++) {
+    if (runs[k] != NULL) {
+      sorted = merge(runs[k], sorted, k == levels - 1 ? &tail : NULL);
+    }
+  }
+  *head = sorted;
+  return tail;
+}
+
+// Function to initialize an empty list handle
+void list_init(List *list) {
+  list->head = NULL;
+  list->tail = NULL;
+  list->size = 0;
+}
+
+// Function to add a node to the front of the list in O(1)
+void list_add_to_front(List *list, int data) {
+  add_to_front(&list->head, data);
+  if (list->tail == NULL) {
+    list->tail = list->head; // First node is also the last
+  }
+  list->size++;
+}
+
+// Function to add a node to the end of the list in O(1)
+void list_add_to_end(List *list, int data) {
+  Node *new_node = create_node(data);
+  if (list->tail == NULL) {
+    list->head = new_node; // If the list is empty, the new node is the head
+  } else {
+    list->tail->next = new_node; // Link the new node after the old tail
   }
+  list->tail = new_node;
+  list->size++;
 }
 
-int main() {
+// Function to get the number of nodes in the list in O(1)
+size_t list_length(const List *list) { return list->size; }
+
+// Function to remove the first node holding data; returns 1 if one was found
+int list_remove_node(List *list, int data) {
+  Node *current = list->head;
+  Node *previous = NULL;
+
+  while (current != NULL && current->data != data) {
+    previous = current;
+    current = current->next;
+  }
+
+  if (current == NULL) {
+    return 0; // Node not found
+  }
+
+  if (previous == NULL) {
+    list->head = current->next; // The node to be deleted is the head
+  } else {
+    previous->next = current->next; // Bypass the node to be deleted
+  }
+  if (current == list->tail) {
+    list->tail = previous; // The node before it is the new tail
+  }
+  list->size--;
+
+  release_node(current); // Return the deleted node to the pool
+  return 1;
+}
+
+// Function to remove every node whose data satisfies pred, keeping the
+// handle's tail and size up to date
+size_t list_remove_if(List *list, int (*pred)(int data, void *arg),
+                      void *arg) {
+  size_t count = remove_if(&list->head, pred, arg, &list->tail);
+  list->size -= count;
+  return count;
+}
+
+// Function to remove every node whose data is one of values[0..n-1]
+size_t list_remove_values(List *list, const int values[], size_t n) {
+  size_t count = remove_values(&list->head, values, n, &list->tail);
+  list->size -= count;
+  return count;
+}
+
+// Function to sort the list by data
+void list_sort(List *list) { list->tail = sort_list(&list->head); }
+
+// Free all nodes in the list and leave the handle empty
+void list_free(List *list) {
+  if (list->head != NULL) {
+    list->tail->next = free_nodes; // Tail is known, so no walk is needed
+    free_nodes = list->head;
+  }
+  list_init(list);
+}
+
+// Function to create an empty, cache-line aligned unrolled node
+UnrolledNode *create_unrolled_node(void) {
+  UnrolledNode *node = aligned_alloc(CACHE_LINE, sizeof(UnrolledNode));
+  if (node == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+  node->next = NULL;
+  node->count = 0;
+  return node;
+}
+
+// Function to initialize an empty unrolled list
+void unrolled_init(UnrolledList *list) {
+  list->head = NULL;
+  list->tail = NULL;
+  list->size = 0;
+}
+
+// Function to add a value to the end of an unrolled list
+void unrolled_add_to_end(UnrolledList *list, int data) {
+  if (list->tail == NULL || list->tail->count == UNROLLED_CAPACITY) {
+    UnrolledNode *node = create_unrolled_node();
+    if (list->tail == NULL) {
+      list->head = node;
+    } else {
+      list->tail->next = node;
+    }
+    list->tail = node;
+  }
+  list->tail->values[list->tail->count++] = data;
+  list->size++;
+}
+
+// Function to check whether data is in an unrolled list. The inner loop
+// covers one cache line without branching, so the compiler can vectorize it.
+int unrolled_contains(const UnrolledList *list, int data) {
+  for (const UnrolledNode *node = list->head; node != NULL;
+       node = node->next) {
+    int hit = 0;
+    for (int i = 0; i < node->count; i++) {
+      hit |= node->values[i] == data;
+    }
+    if (hit) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Function to remove the first occurrence of data; returns 1 if one was
+// found. A node left less than half full takes values from its successor, or
+// absorbs it, so nodes stay dense.
+int unrolled_remove(UnrolledList *list, int data) {
+  UnrolledNode *previous = NULL;
+  for (UnrolledNode *node = list->head; node != NULL;
+       previous = node, node = node->next) {
+    int i = 0;
+    while (i < node->count && node->values[i] != data) {
+      i++;
+    }
+    if (i == node->count) {
+      continue;
+    }
+
+    memmove(&node->values[i], &node->values[i + 1],
+            (node->count - i - 1) * sizeof(int));
+    node->count--;
+    list->size--;
+
+    UnrolledNode *next = node->next;
+    if (node->count == 0) {
+      // Unlink the now empty node
+      if (previous == NULL) {
+        list->head = next;
+      } else {
+        previous->next = next;
+      }
+      if (list->tail == node) {
+        list->tail = previous;
+      }
+      free(node);
+    } else if (next != NULL && node->count < UNROLLED_CAPACITY / 2) {
+      if (node->count + next->count <= UNROLLED_CAPACITY) {
+        // Absorb the successor entirely
+        memcpy(&node->values[node->count], next->values,
+               next->count * sizeof(int));
+        node->count += next->count;
+        node->next = next->next;
+        if (list->tail == next) {
+          list->tail = node;
+        }
+        free(next);
+      } else {
+        // Borrow values from the successor to refill this node
+        int moved = UNROLLED_CAPACITY / 2 - node->count;
+        memcpy(&node->values[node->count], next->values, moved * sizeof(int));
+        memmove(next->values, &next->values[moved],
+                (next->count - moved) * sizeof(int));
+        node->count += moved;
+        next->count -= moved;
+      }
+    }
+    return 1;
+  }
+  return 0; // Value not found
+}
+
+// Function to print an unrolled list
+void unrolled_print(const UnrolledList *list) {
+  for (const UnrolledNode *node = list->head; node != NULL;
+       node = node->next) {
+    for (int i = 0; i < node->count; i++) {
+      printf("%d -> ", node->values[i]);
+    }
+  }
+  printf("NULL\n");
+}
+
+// Free all nodes of an unrolled list
+void unrolled_free(UnrolledList *list) {
+  UnrolledNode *node = list->head;
+  while (node != NULL) {
+    UnrolledNode *next = node->next;
+    free(node);
+    node = next;
+  }
+  unrolled_init(list);
+}
+
+// External variables: the pool skip list towers come from. Towers of the
+// same height are interchangeable, so each height has its own free list.
+static TowerSlab *tower_slabs = NULL;
+static char *tower_cursor = NULL; // Next free byte in the newest slab
+static char *tower_end = NULL;    // End of the newest slab
+static SkipNode *free_towers[SKIP_MAX_LEVEL + 1];
+
+static size_t tower_size(int height) {
+  size_t size = sizeof(SkipNode) + (height - 1) * sizeof(SkipNode *);
+  return (size + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+}
+
+// Function to take a tower of the given height from the pool
+SkipNode *alloc_tower(int height) {
+  SkipNode *tower = free_towers[height];
+  if (tower != NULL) {
+    free_towers[height] = (SkipNode *)tower->node.next; // Reuse a freed one
+    return tower;
+  }
+  size_t size = tower_size(height);
+  if (tower_cursor == NULL || (size_t)(tower_end - tower_cursor) < size) {
+    TowerSlab *slab = (TowerSlab *)malloc(SLAB_SIZE);
+    if (slab == NULL) {
+      fprintf(stderr, "Memory allocation failed!\n");
+      exit(EXIT_FAILURE);
+    }
+    slab->next = tower_slabs;
+    tower_slabs = slab;
+    tower_cursor = (char *)(slab + 1); // Towers start after the header
+    tower_end = (char *)slab + SLAB_SIZE;
+  }
+  tower = (SkipNode *)tower_cursor;
+  tower_cursor += size;
+  return tower;
+}
+
+// Function to give a tower back to the pool
+void release_tower(SkipNode *tower) {
+  tower->node.next = (Node *)free_towers[tower->height];
+  free_towers[tower->height] = tower;
+}
+
+// Release every tower slab at once; all skip lists become invalid
+void destroy_tower_pool(void) {
+  while (tower_slabs != NULL) {
+    TowerSlab *next = tower_slabs->next;
+    free(tower_slabs);
+    tower_slabs = next;
+  }
+  tower_cursor = tower_end = NULL;
+  for (int i = 0; i <= SKIP_MAX_LEVEL; i++) {
+    free_towers[i] = NULL;
+  }
+}
+
+// Function to follow the link of a node at the given level
+static SkipNode *skip_next(const SkipNode *node, int level) {
+  return level == 0 ? (SkipNode *)node->node.next : node->forward[level - 1];
+}
+
+static void skip_set_next(SkipNode *node, int level, SkipNode *next) {
+  if (level == 0) {
+    node->node.next = (Node *)next;
+  } else {
+    node->forward[level - 1] = next;
+  }
+}
+
+// Function to pick a tower height: each extra level with probability 1/4
+static int random_height(void) {
+  static unsigned int state = 2463534242u;
+  int height = 1;
+
+  state ^= state << 13; // xorshift32
+  state ^= state >> 17;
+  state ^= state << 5;
+  for (unsigned int bits = state; (bits & 3) == 0 && height < SKIP_MAX_LEVEL;
+       bits >>= 2) {
+    height++;
+  }
+  return height;
+}
+
+// Function to initialize an empty skip list
+void skip_init(SkipList *list) {
+  list->head = alloc_tower(SKIP_MAX_LEVEL);
+  list->head->height = SKIP_MAX_LEVEL;
+  for (int i = 0; i < SKIP_MAX_LEVEL; i++) {
+    skip_set_next(list->head, i, NULL);
+  }
+  list->level = 1;
+  list->size = 0;
+}
+
+// Function to find, on every level, the last node whose value is below data
+static void skip_find(const SkipList *list, int data,
+                      SkipNode *update[SKIP_MAX_LEVEL]) {
+  SkipNode *current = list->head;
+  for (int level = list->level - 1; level >= 0; level--) {
+    SkipNode *next;
+    while ((next = skip_next(current, level)) != NULL &&
+           next->node.data < data) {
+      current = next;
+    }
+    update[level] = current;
+  }
+}
+
+// Function to check whether data is in the skip list in O(log n)
+int skip_contains(const SkipList *list, int data) {
+  SkipNode *update[SKIP_MAX_LEVEL];
+  skip_find(list, data, update);
+  SkipNode *next = skip_next(update[0], 0);
+  return next != NULL && next->node.data == data;
+}
+
+// Function to insert data in sorted position in O(log n)
+void skip_insert(SkipList *list, int data) {
+  SkipNode *update[SKIP_MAX_LEVEL];
+  skip_find(list, data, update);
+
+  int height = random_height();
+  for (int level = list->level; level < height; level++) {
+    update[level] = list->head; // New levels start at the sentinel
+  }
+  if (height > list->level) {
+    list->level = height;
+  }
+
+  SkipNode *new_node = alloc_tower(height);
+  new_node->node.data = data;
+  new_node->height = height;
+  for (int level = 0; level < height; level++) {
+    skip_set_next(new_node, level, skip_next(update[level], level));
+    skip_set_next(update[level], level, new_node);
+  }
+  list->size++;
+}
+
+// Function to remove one occurrence of data in O(log n); returns 1 if found
+int skip_remove(SkipList *list, int data) {
+  SkipNode *update[SKIP_MAX_LEVEL];
+  skip_find(list, data, update);
+
+  SkipNode *target = skip_next(update[0], 0);
+  if (target == NULL || target->node.data != data) {
+    return 0; // Value not found
+  }
+  for (int level = 0; level < target->height; level++) {
+    skip_set_next(update[level], level, skip_next(target, level));
+  }
+  while (list->level > 1 && skip_next(list->head, list->level - 1) == NULL) {
+    list->level--; // Drop levels that became empty
+  }
+  list->size--;
+
+  release_tower(target);
+  return 1;
+}
+
+// Function to get the sorted values as a plain Node list, for in-order
+// iteration or print_list()
+Node *skip_to_list(const SkipList *list) { return list->head->node.next; }
+
+// Free all towers of the skip list, including its sentinel
+void skip_free(SkipList *list) {
+  SkipNode *current = list->head;
+  while (current != NULL) {
+    SkipNode *next = skip_next(current, 0);
+    release_tower(current);
+    current = next;
+  }
+  list->head = NULL;
+  list->level = 0;
+  list->size = 0;
+}
+
+static double elapsed(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Function to check whether data is in a Node list
+int contains(const Node *head, int data) {
+  for (; head != NULL; head = head->next) {
+    if (head->data == data) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Function to compare searching a Node list and an unrolled list of n values.
+// The Node list is timed twice: freshly built, when the pool hands out its
+// nodes in address order, and aged, when the nodes come back from the pool
+// in random order as they do after a lot of churn.
+void benchmark(size_t n, int searches) {
+  struct timespec start;
+  List list;
+  UnrolledList unrolled;
+
+  srand(1);
+  list_init(&list);
+  unrolled_init(&unrolled);
+  for (size_t i = 0; i < n; i++) {
+    list_add_to_end(&list, (int)i);
+    unrolled_add_to_end(&unrolled, (int)i);
+  }
+
+  // Every search looks for a value that is not there, so it scans it all
+  int found = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < searches; i++) {
+    found += contains(list.head, -1 - i);
+  }
+  double fresh_secs = elapsed(&start);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < searches; i++) {
+    found += unrolled_contains(&unrolled, -1 - i);
+  }
+  double unrolled_secs = elapsed(&start);
+
+  // Rebuild the Node list from nodes recycled in a random order
+  Node **nodes = malloc(n * sizeof(Node *));
+  if (nodes == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+  list_free(&list);
+  for (size_t i = 0; i < n; i++) {
+    nodes[i] = alloc_node();
+  }
+  for (size_t i = n; i > 1; i--) {
+    size_t j = (size_t)rand() % i;
+    Node *temp = nodes[i - 1];
+    nodes[i - 1] = nodes[j];
+    nodes[j] = temp;
+  }
+  for (size_t i = 0; i < n; i++) {
+    release_node(nodes[i]);
+  }
+  free(nodes);
+  for (size_t i = 0; i < n; i++) {
+    list_add_to_end(&list, (int)i);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < searches; i++) {
+    found += contains(list.head, -1 - i);
+  }
+  double aged_secs = elapsed(&start);
+
+  double scanned = (double)n * searches;
+  printf("%zu values, %d scans (%d found): Node list %.2f ns/value fresh, "
+         "%.2f ns/value aged; unrolled list %.2f ns/value\n",
+         n, searches, found, fresh_secs * 1e9 / scanned,
+         aged_secs * 1e9 / scanned, unrolled_secs * 1e9 / scanned);
+
+  list_free(&list);
+  unrolled_free(&unrolled);
+  destroy_pool();
+}
+
+static int compare_ints(const void *a, const void *b) {
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+// Function to compare sorting a list of n random values in place with
+// sort_list() against copying the values out, sorting them with qsort() and
+// rebuilding the list
+void sort_benchmark(size_t n) {
+  struct timespec start;
+  List list;
+
+  // Copy, sort, rebuild
+  srand(2);
+  list_init(&list);
+  for (size_t i = 0; i < n; i++) {
+    list_add_to_end(&list, rand());
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  int *values = malloc((list_length(&list) + 1) * sizeof(int));
+  if (values == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+  size_t count = 0;
+  for (Node *node = list.head; node != NULL; node = node->next) {
+    values[count++] = node->data;
+  }
+  qsort(values, count, sizeof(int), compare_ints);
+  list_free(&list);
+  for (size_t i = 0; i < count; i++) {
+    list_add_to_end(&list, values[i]);
+  }
+  free(values);
+  double copy_secs = elapsed(&start);
+  list_free(&list);
+
+  // The same values, relinked in place
+  srand(2);
+  for (size_t i = 0; i < n; i++) {
+    list_add_to_end(&list, rand());
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  list_sort(&list);
+  double merge_secs = elapsed(&start);
+
+  int sorted = 1;
+  for (Node *node = list.head; node->next != NULL; node = node->next) {
+    sorted &= node->data <= node->next->data;
+  }
+
+  printf("%zu values sorted (%s): copy-sort-rebuild %.1f ns/value, "
+         "in-place merge sort %.1f ns/value\n",
+         n, sorted ? "ok" : "WRONG", copy_secs * 1e9 / n,
+         merge_secs * 1e9 / n);
+
+  list_free(&list);
+  destroy_pool();
+}
+
+static int is_even(int data, void *arg) {
+  (void)arg;
+  return data % 2 == 0;
+}
+
+int main(int argc, char *argv[]) {
+  // ./linked_list N compares scanning N values in a Node list and an
+  // unrolled list, then two ways of sorting a list of N values
+  if (argc > 1) {
+    size_t n = strtoul(argv[1], NULL, 10);
+    benchmark(n, 20);
+    if (n > 0) {
+      sort_benchmark(n);
+    }
+    return 0;
+  }
+
   Node *head = NULL; // Initialize the head of the list
 
   // Add nodes to the linked list
@@ -108,5 +929,67 @@ int main() {
   // Clean up
   free_list(head);
 
+  // The same operations through a list handle
+  List list;
+  list_init(&list);
+  for (int i = 1; i <= 5; i++) {
+    list_add_to_end(&list, i); // O(1) each, no walk to the end
+  }
+  list_add_to_front(&list, 0);
+  list_remove_node(&list, 5); // Removing the tail keeps tail up to date
+  list_add_to_end(&list, 6);
+
+  printf("List handle (%zu nodes): ", list_length(&list));
+  print_list(list.head);
+
+  // Remove several values, or everything matching a predicate, in one pass
+  for (int i = 7; i <= 12; i++) {
+    list_add_to_end(&list, i);
+  }
+  int unwanted[] = {0, 3, 12};
+  list_remove_values(&list, unwanted, 3);
+  list_remove_if(&list, is_even, NULL);
+  printf("Odd values left (%zu nodes): ", list_length(&list));
+  print_list(list.head);
+
+  // Sort by relinking the nodes, without copying the values out
+  list_add_to_front(&list, 8);
+  list_add_to_end(&list, 4);
+  list_sort(&list);
+  list_add_to_end(&list, 20); // tail is still correct after sorting
+  printf("Sorted: ");
+  print_list(list.head);
+
+  list_free(&list);
+  destroy_pool(); // Bulk teardown: release the slabs themselves
+
+  // An unrolled list keeps several values per node
+  UnrolledList unrolled;
+  unrolled_init(&unrolled);
+  for (int i = 1; i <= 30; i++) {
+    unrolled_add_to_end(&unrolled, i);
+  }
+  for (int i = 2; i <= 30; i += 2) {
+    unrolled_remove(&unrolled, i); // Nodes refill from their successors
+  }
+  printf("Unrolled list (%zu values, %d per node): ", unrolled.size,
+         UNROLLED_CAPACITY);
+  unrolled_print(&unrolled);
+  unrolled_free(&unrolled);
+
+  // A skip list keeps its values sorted with O(log n) search
+  SkipList skip;
+  skip_init(&skip);
+  int values[] = {42, 7, 19, 3, 88, 61, 25, 7};
+  for (int i = 0; i < 8; i++) {
+    skip_insert(&skip, values[i]);
+  }
+  skip_remove(&skip, 19);
+  printf("Skip list (%zu values, 25 %s): ", skip.size,
+         skip_contains(&skip, 25) ? "found" : "not found");
+  print_list(skip_to_list(&skip)); // Level 0 is a plain sorted Node list
+  skip_free(&skip);
+  destroy_tower_pool();
+
   return 0;
 }
@@ -0,0 +1,362 @@
+/*
+ * Lock-free singly linked stack (Treiber stack) for sharing a list between
+ * producer and consumer threads without a mutex.
+ *
+ * push_front() and pop_front() are the add_to_front() and "remove the head"
+ * operations of linked_list.c, done with a compare-and-swap on the head.
+ *
+ * The classic hazard of this scheme is ABA: a thread reads head A and its
+ * successor B, gets preempted, other threads pop A, pop B and push A again,
+ * and the first thread's CAS then succeeds and installs the stale B. To rule
+ * that out, nodes live in a pool and are addressed by 32-bit index, and the
+ * head is a 64-bit word holding the index together with a 32-bit tag that is
+ * bumped by every successful CAS. A recycled node therefore never makes an
+ * old head value look current. Because pool nodes are never returned to the
+ * system, reading the next field of a node some other thread has just popped
+ * is harmless: the value is stale and the CAS fails.
+ *
+ * The pool grows on demand in segments of SEGMENT_SIZE nodes; an index is a
+ * (segment, slot) pair. Segments are never moved or freed before
+ * pool_destroy(), so an index stays valid for the life of the pool. Growing
+ * takes a mutex, but only when the free list is empty; pushes and pops that
+ * reuse nodes stay lock-free. The stack holds at most
+ * MAX_SEGMENTS * SEGMENT_SIZE (2^28) values at once; push_front() fails
+ * beyond that.
+ *
+ * Build: cc -O2 -pthread lockfree_list.c
+ * Usage: ./a.out [max_threads]   (stress test, then throughput benchmark)
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NIL UINT32_MAX // index meaning "no node"
+#define SEGMENT_BITS 12
+#define SEGMENT_SIZE (1u << SEGMENT_BITS) // nodes added per growth
+#define MAX_SEGMENTS (1u << 16)           // keeps every index below NIL
+#define MAX_THREADS 64
+
+#define STRESS_ITEMS 200000 // values each producer pushes in the stress test
+#define BENCH_OPS 1000000   // push/pop pairs per thread in the benchmark
+
+typedef struct {
+  int data;
+  _Atomic uint32_t next; // index of the next node, NIL at the end
+} Node;
+
+// Head of a stack: the top index in the low half, an ABA tag in the high half
+typedef struct {
+  _Atomic uint64_t head;
+} Stack;
+
+// Growable set of nodes; the unused ones sit on their own lock-free stack
+typedef struct {
+  Node *_Atomic *segments; // MAX_SEGMENTS slots, filled in order
+  uint32_t segment_count;  // guarded by grow_lock
+  pthread_mutex_t grow_lock;
+  Stack free_nodes;
+} NodePool;
+
+void stack_init(Stack *stack);
+void pool_init(NodePool *pool);
+void pool_destroy(NodePool *pool);
+int push_front(Stack *stack, NodePool *pool, int data);
+int pop_front(Stack *stack, NodePool *pool, int *data);
+
+static uint64_t pack(uint32_t index, uint32_t tag) {
+  return (uint64_t)tag << 32 | index;
+}
+
+static uint32_t index_of(uint64_t head) { return (uint32_t)head; }
+static uint32_t tag_of(uint64_t head) { return (uint32_t)(head >> 32); }
+
+void stack_init(Stack *stack) { atomic_init(&stack->head, pack(NIL, 0)); }
+
+// Node with the given index. Any index a thread can see was published after
+// its segment, so the segment pointer is already set.
+static Node *node_at(NodePool *pool, uint32_t index) {
+  Node *segment = atomic_load_explicit(&pool->segments[index >> SEGMENT_BITS],
+                                       memory_order_acquire);
+  return &segment[index & (SEGMENT_SIZE - 1)];
+}
+
+// Link the chain of nodes first...last on top of stack
+static void push_chain(Stack *stack, NodePool *pool, uint32_t first,
+                       uint32_t last) {
+  uint64_t old = atomic_load_explicit(&stack->head, memory_order_relaxed);
+
+  do {
+    atomic_store_explicit(&node_at(pool, last)->next, index_of(old),
+                          memory_order_relaxed);
+    // Release publishes the node's data and next with the new head
+  } while (!atomic_compare_exchange_weak_explicit(
+      &stack->head, &old, pack(first, tag_of(old) + 1), memory_order_release,
+      memory_order_relaxed));
+}
+
+// Link node index on top of stack
+static void push_index(Stack *stack, NodePool *pool, uint32_t index) {
+  push_chain(stack, pool, index, index);
+}
+
+// Unlink the top node of stack and return its index, or NIL if it is empty
+static uint32_t pop_index(Stack *stack, NodePool *pool) {
+  uint64_t old = atomic_load_explicit(&stack->head, memory_order_acquire);
+
+  for (;;) {
+    uint32_t top = index_of(old);
+    if (top == NIL) {
+      return NIL;
+    }
+    // May be stale if another thread wins the race; the tag makes our CAS
+    // fail in that case
+    uint32_t next =
+        atomic_load_explicit(&node_at(pool, top)->next, memory_order_relaxed);
+    if (atomic_compare_exchange_weak_explicit(&stack->head, &old,
+                                              pack(next, tag_of(old) + 1),
+                                              memory_order_acquire,
+                                              memory_order_acquire)) {
+      return top;
+    }
+  }
+}
+
+// Start with no nodes; the first push_front() adds a segment
+void pool_init(NodePool *pool) {
+  pool->segments = calloc(MAX_SEGMENTS, sizeof(Node *));
+  if (pool->segments == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+  pool->segment_count = 0;
+  pthread_mutex_init(&pool->grow_lock, NULL);
+  stack_init(&pool->free_nodes);
+}
+
+// Only safe once no thread uses the pool or any stack built from it
+void pool_destroy(NodePool *pool) {
+  for (uint32_t i = 0; i < pool->segment_count; i++) {
+    free(atomic_load_explicit(&pool->segments[i], memory_order_relaxed));
+  }
+  free(pool->segments);
+  pthread_mutex_destroy(&pool->grow_lock);
+}
+
+// Take a free node, adding a segment if there is none. Returns NIL only when
+// all MAX_SEGMENTS segments are in use.
+static uint32_t take_node(NodePool *pool) {
+  uint32_t index = pop_index(&pool->free_nodes, pool);
+  if (index != NIL) {
+    return index;
+  }
+
+  pthread_mutex_lock(&pool->grow_lock);
+  index = pop_index(&pool->free_nodes, pool); // another thread may have grown
+  if (index == NIL && pool->segment_count < MAX_SEGMENTS) {
+    Node *segment = malloc(sizeof(Node) * SEGMENT_SIZE);
+    if (segment == NULL) {
+      fprintf(stderr, "Memory allocation failed!\n");
+      exit(EXIT_FAILURE);
+    }
+    uint32_t first = pool->segment_count << SEGMENT_BITS;
+
+    // Chain slots 1...SEGMENT_SIZE - 1 together before anyone can see them
+    for (uint32_t i = 1; i < SEGMENT_SIZE; i++) {
+      atomic_init(&segment[i].next, i + 1 < SEGMENT_SIZE ? first + i + 1 : NIL);
+    }
+    atomic_init(&segment[0].next, NIL);
+    atomic_store_explicit(&pool->segments[pool->segment_count], segment,
+                          memory_order_release);
+    pool->segment_count++;
+
+    // Keep slot 0 for the caller and free the rest with a single CAS
+    push_chain(&pool->free_nodes, pool, first + 1, first + SEGMENT_SIZE - 1);
+    index = first;
+  }
+  pthread_mutex_unlock(&pool->grow_lock);
+  return index;
+}
+
+// Push data on the stack; returns 0 only if the stack already holds
+// MAX_SEGMENTS * SEGMENT_SIZE values
+int push_front(Stack *stack, NodePool *pool, int data) {
+  uint32_t index = take_node(pool);
+  if (index == NIL) {
+    return 0;
+  }
+  node_at(pool, index)->data = data;
+  push_index(stack, pool, index);
+  return 1;
+}
+
+// Pop the front value into *data; returns 0 if the stack was empty
+int pop_front(Stack *stack, NodePool *pool, int *data) {
+  uint32_t index = pop_index(stack, pool);
+  if (index == NIL) {
+    return 0;
+  }
+  *data = node_at(pool, index)->data;
+  push_index(&pool->free_nodes, pool, index);
+  return 1;
+}
+
+typedef struct {
+  Stack *stack;
+  NodePool *pool;
+  int id;
+  atomic_int *producers_left;
+  unsigned char *seen; // consumers mark every value they pop
+  long popped;
+  long duplicates;
+} Worker;
+
+static void *producer_main(void *arg) {
+  Worker *worker = arg;
+
+  for (int i = 0; i < STRESS_ITEMS; i++) {
+    while (!push_front(worker->stack, worker->pool,
+                       worker->id * STRESS_ITEMS + i)) {
+      sched_yield(); // stack full: let the consumers catch up
+    }
+  }
+  atomic_fetch_sub(worker->producers_left, 1);
+  return NULL;
+}
+
+static void *consumer_main(void *arg) {
+  Worker *worker = arg;
+  int data;
+
+  for (;;) {
+    if (pop_front(worker->stack, worker->pool, &data)) {
+      // Each value has exactly one owner, so no other thread writes this byte
+      if (worker->seen[data]++) {
+        worker->duplicates++;
+      }
+      worker->popped++;
+    } else if (atomic_load(worker->producers_left) > 0) {
+      sched_yield(); // empty for now: let the producers run
+    } else {
+      // Producers are done; drain what is left, then stop
+      if (!pop_front(worker->stack, worker->pool, &data)) {
+        break;
+      }
+      if (worker->seen[data]++) {
+        worker->duplicates++;
+      }
+      worker->popped++;
+    }
+  }
+  return NULL;
+}
+
+// Producers push distinct values while consumers pop them; every value must
+// come out exactly once. Returns 1 if the run was clean.
+int stress_test(int producers, int consumers) {
+  NodePool pool;
+  Stack stack;
+  pthread_t tids[2 * MAX_THREADS];
+  Worker workers[2 * MAX_THREADS];
+  atomic_int producers_left = producers;
+  long total = (long)producers * STRESS_ITEMS;
+  unsigned char *seen = calloc(total, 1);
+
+  if (seen == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+
+  pool_init(&pool);
+  stack_init(&stack);
+
+  for (int i = 0; i < producers + consumers; i++) {
+    workers[i] =
+        (Worker){&stack, &pool, i, &producers_left, seen, 0, 0};
+    pthread_create(&tids[i], NULL,
+                   i < producers ? producer_main : consumer_main, &workers[i]);
+  }
+
+  long popped = 0, duplicates = 0;
+  for (int i = 0; i < producers + consumers; i++) {
+    pthread_join(tids[i], NULL);
+    popped += workers[i].popped;
+    duplicates += workers[i].duplicates;
+  }
+
+  long missing = 0;
+  for (long i = 0; i < total; i++) {
+    missing += seen[i] == 0;
+  }
+
+  printf("stress %d producers / %d consumers: %ld pushed, %ld popped, "
+         "%ld duplicates, %ld missing\n",
+         producers, consumers, total, popped, duplicates, missing);
+
+  free(seen);
+  pool_destroy(&pool);
+  return popped == total && duplicates == 0 && missing == 0;
+}
+
+static void *bench_main(void *arg) {
+  Worker *worker = arg;
+  int data;
+
+  for (int i = 0; i < BENCH_OPS; i++) {
+    push_front(worker->stack, worker->pool, i);
+    pop_front(worker->stack, worker->pool, &data);
+  }
+  return NULL;
+}
+
+// Every thread does push/pop pairs on one shared stack
+void benchmark(int threads) {
+  NodePool pool;
+  Stack stack;
+  pthread_t tids[MAX_THREADS];
+  Worker workers[MAX_THREADS];
+  struct timespec start, end;
+
+  pool_init(&pool);
+  stack_init(&stack);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < threads; i++) {
+    workers[i] = (Worker){&stack, &pool, i, NULL, NULL, 0, 0};
+    pthread_create(&tids[i], NULL, bench_main, &workers[i]);
+  }
+  for (int i = 0; i < threads; i++) {
+    pthread_join(tids[i], NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double secs =
+      (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  printf("%7d  %12.0f\n", threads, 2.0 * BENCH_OPS * threads / secs);
+
+  pool_destroy(&pool);
+}
+
+int main(int argc, char *argv[]) {
+  int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+  if (max_threads < 1 || max_threads > MAX_THREADS) {
+    fprintf(stderr, "max_threads must be between 1 and %d\n", MAX_THREADS);
+    return EXIT_FAILURE;
+  }
+
+  int clean = stress_test(max_threads, max_threads);
+  if (!clean) {
+    fprintf(stderr, "stress test FAILED\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("threads  ops/s\n");
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    benchmark(threads);
+  }
+
+  return 0;
+}
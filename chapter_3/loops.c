@@ -136,6 +136,71 @@ void shellsort(int v[], int n) {
  * the various parts, for example to process two indices in parallel.
  */
 
+/***
+ * - Halving the gap is Shell's original sequence. It is simple, but the gaps
+ * share factors: with n a power of two, elements at even positions are not
+ * compared with elements at odd positions until the very last pass, and the
+ * worst case is O(n^2).
+ * - Better sequences are known. Tokuda's grows by a factor of about 2.25 and
+ * Ciura's was found by experiment (1, 4, 10, 23, 57, 132, 301, 701, 1750) and
+ * is usually extended by the same factor. Both do noticeably fewer
+ * comparisons.
+ * - The inner loop above also exchanges each out-of-order pair with three
+ * assignments. Holding v[i] aside and shifting larger elements up by gap,
+ * as insertion sort does, takes one assignment per step instead.
+ * - shellsort_gaps takes the gap sequence as a parameter, so the sequences
+ * can be compared on the same data.
+ */
+enum gap_sequence { SHELL_GAPS, CIURA_GAPS, TOKUDA_GAPS };
+
+#define MAX_GAPS 64
+
+/* gaps: store the gaps smaller than n in increasing order; return how many */
+static int gaps(enum gap_sequence seq, int n, int gap[]) {
+  static const int ciura[] = {1, 4, 10, 23, 57, 132, 301, 701, 1750};
+  int k = 0;
+  double h;
+
+  switch (seq) {
+  case SHELL_GAPS: // n/2, n/4, ..., 1, stored smallest first
+    for (int g = n / 2; g > 0; g /= 2)
+      k++;
+    for (int i = k - 1, g = n / 2; g > 0; g /= 2)
+      gap[i--] = g;
+    break;
+  case CIURA_GAPS: // extended past 1750 by a factor of 2.25
+    for (h = ciura[0]; h < n && k < MAX_GAPS; h = k < 9 ? ciura[k] : h * 2.25)
+      gap[k++] = (int)h;
+    break;
+  case TOKUDA_GAPS: // ceil((9 (9/4)^k - 4) / 5)
+    for (h = 1; k < MAX_GAPS; h *= 2.25) {
+      double t = (9 * h - 4) / 5;
+      int g = (int)t < t ? (int)t + 1 : (int)t;
+      if (g >= n)
+        break;
+      gap[k++] = g;
+    }
+    break;
+  }
+  return k;
+}
+
+/* shellsort_gaps: sort v[0]...v[n-1] into increasing order using seq */
+void shellsort_gaps(int v[], int n, enum gap_sequence seq) {
+  int gap[MAX_GAPS];
+  int k, i, j, g, temp;
+
+  for (k = gaps(seq, n, gap); k-- > 0;) {
+    g = gap[k];
+    for (i = g; i < n; i++) {
+      temp = v[i];
+      for (j = i; j >= g && v[j - g] > temp; j -= g)
+        v[j] = v[j - g]; // shift up instead of swapping
+      v[j] = temp;
+    }
+  }
+}
+
 /***
  * - The commas that seperate function arguments, variables in declarations,
  * etc., are not comma operators, and do not guarantee left to right evaluation.
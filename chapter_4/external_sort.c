@@ -0,0 +1,443 @@
+/*
+ * External merge sort for files of ints too large to sort in memory
+ *
+ * The input is a file of native-endian 32-bit ints. It is sorted in two
+ * phases, neither of which holds more than the memory budget:
+ *
+ * 1. Runs. The input is read a chunk at a time, each chunk is sorted in
+ *    memory with an LSD radix sort (the one from chapter_2/array.c: half of
+ *    the budget holds the chunk, the other half is its scratch buffer) and
+ *    written to a temporary file of its own.
+ *
+ * 2. Merge. All runs are read at once, each through its own buffer, and
+ *    merged with a loser tree: a tournament tree whose inner nodes remember
+ *    the loser of each match, so replacing the winner with the next value of
+ *    its run replays only the log2(k) matches on its path to the root. If
+ *    there are so many runs that their buffers would get too small for
+ *    efficient reads, groups of runs are first merged into longer runs.
+ *
+ * All I/O is done in large sequential blocks, one fread() or fwrite() per
+ * buffer, and the kernel is told the files are read sequentially so it reads
+ * ahead of the merge. The temporary files are unlinked as soon as they are
+ * created, so nothing is left behind if the program dies.
+ *
+ * Usage: ./a.out [-m MEGABYTES] [-T DIR] INPUT OUTPUT   sort INPUT to OUTPUT
+ *        ./a.out -g COUNT FILE                          write COUNT random ints
+ */
+#define _XOPEN_SOURCE 600 // for mkstemp() and posix_fadvise()
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_BUDGET (256u << 20) // bytes of memory for sorting
+#define MIN_BUFFER (1u << 18)       // smallest read buffer worth merging with
+#define RADIX_BITS 11
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define RADIX_PASSES ((32 + RADIX_BITS - 1) / RADIX_BITS)
+
+typedef struct {
+  FILE *fp;
+  size_t count; // ints in the run
+} Run;
+
+// A run being merged: a window of buf[pos..len-1] into the rest of the run
+typedef struct {
+  FILE *fp;
+  int *buf;
+  size_t size;      // capacity of buf
+  size_t pos, len;  // next value and end of the buffered values
+  size_t remaining; // values of the run not read into buf yet
+} Reader;
+
+// The loser tree of a k-way merge. tree[1..k-1] are the inner nodes, each
+// holding the run that lost the match there; tree[0] is the overall winner.
+// Leaf i sits at position k + i, so the parent of node n is n / 2.
+typedef struct {
+  int k;
+  int *tree;
+  Reader *readers;
+  int *keys;          // current value of each run
+  unsigned char *done; // 1 once a run is used up
+} LoserTree;
+
+typedef struct {
+  FILE *fp;
+  int *buf;
+  size_t size, len;
+} Writer;
+
+int external_sort(const char *input, const char *output, size_t budget,
+                  const char *tmpdir);
+
+static void *allocate(size_t size) {
+  void *p = malloc(size ? size : 1);
+  if (p == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+  return p;
+}
+
+static void io_error(const char *what) {
+  perror(what);
+  exit(EXIT_FAILURE);
+}
+
+// Tell the kernel to read ahead: the file is read from start to end
+static void advise_sequential(FILE *fp) {
+  posix_fadvise(fileno(fp), 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+// Open an anonymous temporary file in dir; it disappears when closed
+static FILE *temp_file(const char *dir) {
+  char path[4096];
+  snprintf(path, sizeof(path), "%s/extsortXXXXXX", dir);
+
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    io_error(path);
+  }
+  unlink(path);
+
+  FILE *fp = fdopen(fd, "w+b");
+  if (fp == NULL) {
+    io_error(path);
+  }
+  setvbuf(fp, NULL, _IONBF, 0); // all transfers are already large
+  return fp;
+}
+
+static size_t read_ints(FILE *fp, int *buf, size_t n) {
+  size_t got = fread(buf, sizeof(int), n, fp);
+  if (got < n && ferror(fp)) {
+    io_error("read");
+  }
+  return got;
+}
+
+static void write_ints(FILE *fp, const int *buf, size_t n) {
+  if (fwrite(buf, sizeof(int), n, fp) != n) {
+    io_error("write");
+  }
+}
+
+// LSD radix sort of n ints, as in chapter_2/array.c, with caller's scratch
+static void radix_sort(int arr[], int scratch[], size_t n) {
+  size_t counts[RADIX_PASSES][RADIX_SIZE];
+  uint32_t *src = (uint32_t *)arr, *dst = (uint32_t *)scratch;
+
+  memset(counts, 0, sizeof(counts));
+  for (size_t i = 0; i < n; i++) {
+    uint32_t key = src[i] ^ 0x80000000u;
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+      counts[pass][(key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+    }
+  }
+
+  for (int pass = 0; pass < RADIX_PASSES && n > 1; pass++) {
+    int shift = pass * RADIX_BITS;
+    size_t *count = counts[pass], sum = 0;
+
+    if (count[((src[0] ^ 0x80000000u) >> shift) & (RADIX_SIZE - 1)] == n) {
+      continue; // every value has the same digit
+    }
+    for (int d = 0; d < RADIX_SIZE; d++) {
+      size_t c = count[d];
+      count[d] = sum;
+      sum += c;
+    }
+    for (size_t i = 0; i < n; i++) {
+      uint32_t key = src[i] ^ 0x80000000u;
+      dst[count[(key >> shift) & (RADIX_SIZE - 1)]++] = src[i];
+    }
+    uint32_t *temp = src;
+    src = dst;
+    dst = temp;
+  }
+  if (src != (uint32_t *)arr) {
+    memcpy(arr, src, n * sizeof(int));
+  }
+}
+
+// Phase 1: cut the input into sorted runs of at most run_len ints. Returns
+// the runs and stores their number in *nruns.
+static Run *make_runs(FILE *in, size_t run_len, const char *tmpdir,
+                      size_t *nruns) {
+  int *buf = allocate(run_len * sizeof(int));
+  int *scratch = allocate(run_len * sizeof(int));
+  size_t capacity = 16, count = 0, n;
+  Run *runs = allocate(capacity * sizeof(Run));
+
+  while ((n = read_ints(in, buf, run_len)) > 0) {
+    radix_sort(buf, scratch, n);
+
+    if (count == capacity) {
+      capacity *= 2;
+      runs = realloc(runs, capacity * sizeof(Run));
+      if (runs == NULL) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+      }
+    }
+    runs[count].fp = temp_file(tmpdir);
+    runs[count].count = n;
+    write_ints(runs[count].fp, buf, n);
+    count++;
+  }
+
+  free(scratch);
+  free(buf);
+  *nruns = count;
+  return runs;
+}
+
+// Move the reader to the next value; returns 0 when the run is used up
+static int reader_advance(Reader *r) {
+  if (++r->pos < r->len) {
+    return 1;
+  }
+  if (r->remaining == 0) {
+    return 0;
+  }
+  size_t want = r->remaining < r->size ? r->remaining : r->size;
+  r->len = read_ints(r->fp, r->buf, want);
+  if (r->len != want) {
+    fprintf(stderr, "temporary run file is truncated\n");
+    exit(EXIT_FAILURE);
+  }
+  r->remaining -= r->len;
+  r->pos = 0;
+  return 1;
+}
+
+// 1 if run a should come out before run b
+static int wins(const LoserTree *lt, int a, int b) {
+  if (lt->done[a] || lt->done[b]) {
+    return !lt->done[a];
+  }
+  return lt->keys[a] < lt->keys[b] ||
+         (lt->keys[a] == lt->keys[b] && a < b); // earlier run first
+}
+
+// Play the matches on the path from leaf i to the root
+static void replay(LoserTree *lt, int i) {
+  int winner = i;
+
+  for (int node = (lt->k + i) / 2; node > 0; node /= 2) {
+    if (wins(lt, lt->tree[node], winner)) {
+      int loser = winner;
+      winner = lt->tree[node];
+      lt->tree[node] = loser;
+    }
+  }
+  lt->tree[0] = winner;
+}
+
+// Build the tree bottom-up: winners[n] is the winner below node n
+static void build_tree(LoserTree *lt) {
+  int k = lt->k;
+  int *winners = allocate(2 * k * sizeof(int));
+
+  for (int i = 0; i < k; i++) {
+    winners[k + i] = i;
+  }
+  for (int n = k - 1; n > 0; n--) {
+    int a = winners[2 * n], b = winners[2 * n + 1];
+    if (!wins(lt, a, b)) {
+      int temp = a;
+      a = b;
+      b = temp;
+    }
+    winners[n] = a;
+    lt->tree[n] = b;
+  }
+  lt->tree[0] = k > 1 ? winners[1] : 0;
+  free(winners);
+}
+
+// Phase 2: merge runs[0..k-1], k >= 1, into out, with buffer_len ints per
+// buffer
+static void merge_runs(Run *runs, int k, FILE *out, size_t buffer_len) {
+  LoserTree lt;
+  Writer w = {out, allocate(buffer_len * sizeof(int)), buffer_len, 0};
+
+  lt.k = k;
+  lt.tree = allocate(k * sizeof(int));
+  lt.readers = allocate(k * sizeof(Reader));
+  lt.keys = allocate(k * sizeof(int));
+  lt.done = allocate(k);
+
+  for (int i = 0; i < k; i++) {
+    Reader *r = &lt.readers[i];
+    rewind(runs[i].fp);
+    advise_sequential(runs[i].fp);
+    *r = (Reader){runs[i].fp, allocate(buffer_len * sizeof(int)), buffer_len,
+                  0, 0, runs[i].count};
+    r->pos = (size_t)-1; // so the first advance fills the buffer
+    lt.done[i] = !reader_advance(r);
+    if (!lt.done[i]) {
+      lt.keys[i] = r->buf[r->pos];
+    }
+  }
+  build_tree(&lt);
+
+  for (;;) {
+    int i = lt.tree[0];
+    if (lt.done[i]) {
+      break; // the best run is used up, so all of them are
+    }
+    w.buf[w.len++] = lt.keys[i];
+    if (w.len == w.size) {
+      write_ints(w.fp, w.buf, w.len);
+      w.len = 0;
+    }
+
+    Reader *r = &lt.readers[i];
+    if (reader_advance(r)) {
+      lt.keys[i] = r->buf[r->pos];
+    } else {
+      lt.done[i] = 1;
+    }
+    replay(&lt, i);
+  }
+  write_ints(w.fp, w.buf, w.len);
+
+  for (int i = 0; i < k; i++) {
+    free(lt.readers[i].buf);
+    fclose(runs[i].fp); // deletes the temporary file
+  }
+  free(lt.done);
+  free(lt.keys);
+  free(lt.readers);
+  free(lt.tree);
+  free(w.buf);
+}
+
+/*
+ * Sort the ints in input into output using about budget bytes of memory and
+ * temporary files in tmpdir. Returns 0 on success and -1 (with a message on
+ * stderr) if a file cannot be opened; I/O errors later on are fatal.
+ */
+int external_sort(const char *input, const char *output, size_t budget,
+                  const char *tmpdir) {
+  FILE *in = fopen(input, "rb");
+  if (in == NULL) {
+    perror(input);
+    return -1;
+  }
+  setvbuf(in, NULL, _IONBF, 0);
+  advise_sequential(in);
+
+  if (budget < 4 * MIN_BUFFER) {
+    budget = 4 * MIN_BUFFER;
+  }
+  size_t nruns;
+  Run *runs = make_runs(in, budget / 2 / sizeof(int), tmpdir, &nruns);
+  fclose(in);
+
+  // Each run and the output get a buffer of at least MIN_BUFFER bytes
+  size_t max_fanin = budget / MIN_BUFFER - 1;
+  while (nruns > max_fanin) {
+    // Too many runs for one merge: merge groups of them into longer runs
+    size_t merged = 0;
+    for (size_t first = 0; first < nruns; first += max_fanin) {
+      size_t k = nruns - first < max_fanin ? nruns - first : max_fanin;
+      Run run = {temp_file(tmpdir), 0};
+      for (size_t i = first; i < first + k; i++) {
+        run.count += runs[i].count;
+      }
+      merge_runs(runs + first, k, run.fp, budget / (k + 1) / sizeof(int));
+      runs[merged++] = run;
+    }
+    nruns = merged;
+  }
+
+  FILE *out = fopen(output, "wb");
+  if (out == NULL) {
+    perror(output);
+    for (size_t i = 0; i < nruns; i++) {
+      fclose(runs[i].fp);
+    }
+    free(runs);
+    return -1;
+  }
+  setvbuf(out, NULL, _IONBF, 0);
+  if (nruns > 0) { // an empty input gives an empty output
+    merge_runs(runs, nruns, out, budget / (nruns + 1) / sizeof(int));
+  }
+  if (fclose(out) != 0) {
+    io_error(output);
+  }
+
+  free(runs);
+  return 0;
+}
+
+// Write count random ints to path, for trying the sort out
+static int generate(const char *path, size_t count) {
+  FILE *fp = fopen(path, "wb");
+  int buf[4096];
+
+  if (fp == NULL) {
+    perror(path);
+    return -1;
+  }
+  srand(time(NULL));
+  while (count > 0) {
+    size_t n = count < 4096 ? count : 4096;
+    for (size_t i = 0; i < n; i++) {
+      buf[i] = (int)((unsigned)rand() << 16 ^ (unsigned)rand());
+    }
+    write_ints(fp, buf, n);
+    count -= n;
+  }
+  return fclose(fp) == 0 ? 0 : -1;
+}
+
+static double elapsed(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+  size_t budget = DEFAULT_BUDGET;
+  const char *tmpdir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+  int i = 1;
+
+  if (argc == 4 && strcmp(argv[1], "-g") == 0) {
+    return generate(argv[3], strtoul(argv[2], NULL, 10)) == 0
+               ? 0
+               : EXIT_FAILURE;
+  }
+
+  for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+    if (strcmp(argv[i], "-m") == 0) {
+      budget = strtoul(argv[i + 1], NULL, 10) << 20;
+    } else if (strcmp(argv[i], "-T") == 0) {
+      tmpdir = argv[i + 1];
+    } else {
+      break;
+    }
+  }
+  if (argc - i != 2) {
+    fprintf(stderr,
+            "usage: %s [-m MEGABYTES] [-T DIR] INPUT OUTPUT\n"
+            "       %s -g COUNT FILE\n",
+            argv[0], argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  if (external_sort(argv[i], argv[i + 1], budget, tmpdir) != 0) {
+    return EXIT_FAILURE;
+  }
+  fprintf(stderr, "sorted %s in %.2f s with %zu MB of memory\n", argv[i],
+          elapsed(&start), budget >> 20);
+  return 0;
+}
@@ -0,0 +1,411 @@
+/*
+ * Parallel in-place quicksort on a work-stealing pool of threads
+ *
+ * The array is split the way qsort_() in recursion.c splits it: a
+ * median-of-three (or ninther) pivot, Bentley-McIlroy three-way partitioning
+ * so runs of equal values are finished at once, the sorting network of
+ * sort_network.h (or insertion sort) for tiny ranges and a heapsort fallback
+ * when the pivots keep going bad. The difference is what happens to the two
+ * sides of a partition. A worker keeps the larger side for itself and, if the
+ * smaller one is still big enough to be worth moving to another core, pushes
+ * it on its own deque as a task.
+ *
+ * Every worker owns a deque of tasks. It pushes and pops at the tail, so it
+ * keeps working on the most recently split, cache-warm part of the array. An
+ * idle worker steals from the head of some other worker's deque, which is
+ * where the oldest and therefore largest tasks are. One steal hands over a
+ * big piece of work, so steals are rare and a mutex per deque is cheap enough.
+ *
+ * The sort is finished when every element has reached its final place. Each
+ * worker subtracts the elements it finishes (pivot runs and sorted leaves)
+ * from a shared count, and all workers stop once it drops to zero.
+ *
+ * The first partition of the whole array runs on one thread, and the next
+ * few levels on only a few. That sequential part is about 2n of the n log2 n
+ * element moves in total, so for very many threads it bounds the speedup.
+ *
+ * Build: cc -O2 -pthread parallel_sort.c
+ * Usage: ./a.out [N] [MAX_THREADS]   sort N random ints with 1, 2, 4, ...
+ *                                    threads and report the speedup
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sort_network.h"
+
+#define MAX_THREADS 256
+#define CUTOFF 24         // ranges this small go to the leaf sort
+#define GRAIN (1 << 14)   // smallest range handed out as a separate task
+#define NINTHER_MIN 128   // ranges this large use the ninther as pivot
+
+typedef struct {
+  size_t lo, hi; // sort v[lo]...v[hi-1]
+  int depth;     // partitions left before falling back to heapsort
+} Task;
+
+// Tasks of one worker: tasks[head..tail-1], stolen at head, owned at tail
+typedef struct {
+  pthread_mutex_t lock;
+  Task *tasks;
+  size_t head, tail, capacity;
+} Deque;
+
+typedef struct {
+  int *v;
+  int threads;
+  Deque deques[MAX_THREADS];
+  atomic_size_t remaining; // elements not yet in their final place
+} Pool;
+
+typedef struct {
+  Pool *pool;
+  int id;
+  unsigned int seed; // picks steal victims
+} Worker;
+
+void parallel_sort(int v[], size_t n, int threads);
+
+static void deque_init(Deque *deque) {
+  pthread_mutex_init(&deque->lock, NULL);
+  deque->capacity = 64;
+  deque->tasks = malloc(sizeof(Task) * deque->capacity);
+  if (deque->tasks == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+  deque->head = deque->tail = 0;
+}
+
+static void deque_destroy(Deque *deque) {
+  pthread_mutex_destroy(&deque->lock);
+  free(deque->tasks);
+}
+
+static void push_task(Deque *deque, Task task) {
+  pthread_mutex_lock(&deque->lock);
+  if (deque->tail == deque->capacity) {
+    if (deque->head > 0) {
+      // Reuse the room left by stolen tasks
+      memmove(deque->tasks, deque->tasks + deque->head,
+              sizeof(Task) * (deque->tail - deque->head));
+      deque->tail -= deque->head;
+      deque->head = 0;
+    } else {
+      deque->capacity *= 2;
+      deque->tasks = realloc(deque->tasks, sizeof(Task) * deque->capacity);
+      if (deque->tasks == NULL) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
+  deque->tasks[deque->tail++] = task;
+  pthread_mutex_unlock(&deque->lock);
+}
+
+// Take a task from the tail (owner) or the head (thief); 0 if there is none
+static int take_task(Deque *deque, Task *task, int steal) {
+  int found = 0;
+
+  pthread_mutex_lock(&deque->lock);
+  if (deque->head < deque->tail) {
+    *task = steal ? deque->tasks[deque->head++] : deque->tasks[--deque->tail];
+    if (deque->head == deque->tail) {
+      deque->head = deque->tail = 0;
+    }
+    found = 1;
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return found;
+}
+
+static void swap(int v[], size_t i, size_t j) {
+  int temp = v[i];
+  v[i] = v[j];
+  v[j] = temp;
+}
+
+static void insertion_sort(int v[], size_t lo, size_t hi) {
+  for (size_t i = lo + 1; i < hi; i++) {
+    int temp = v[i];
+    size_t j = i;
+    for (; j > lo && v[j - 1] > temp; j--) {
+      v[j] = v[j - 1];
+    }
+    v[j] = temp;
+  }
+}
+
+static void sift_down(int v[], size_t root, size_t n) {
+  int temp = v[root];
+  size_t child;
+
+  while ((child = 2 * root + 1) < n) {
+    if (child + 1 < n && v[child + 1] > v[child]) {
+      child++;
+    }
+    if (v[child] <= temp) {
+      break;
+    }
+    v[root] = v[child];
+    root = child;
+  }
+  v[root] = temp;
+}
+
+static void heap_sort(int v[], size_t n) {
+  for (size_t i = n / 2; i-- > 0;) {
+    sift_down(v, i, n);
+  }
+  for (size_t i = n - 1; i > 0; i--) {
+    swap(v, 0, i);
+    sift_down(v, 0, i);
+  }
+}
+
+static size_t median3(const int v[], size_t a, size_t b, size_t c) {
+  if (v[a] < v[b]) {
+    return v[b] < v[c] ? b : (v[a] < v[c] ? c : a);
+  }
+  return v[a] < v[c] ? a : (v[b] < v[c] ? c : b);
+}
+
+static size_t choose_pivot(const int v[], size_t lo, size_t hi) {
+  size_t n = hi - lo, mid = lo + n / 2, step = n / 8;
+
+  if (n < NINTHER_MIN) {
+    return median3(v, lo, mid, hi - 1);
+  }
+  return median3(v, median3(v, lo, lo + step, lo + 2 * step),
+                 median3(v, mid - step, mid, mid + step),
+                 median3(v, hi - 1 - 2 * step, hi - 1 - step, hi - 1));
+}
+
+// Three-way partition of v[lo..hi-1] (at least two elements) around a chosen
+// pivot. Afterwards v[lo..*lt-1] < pivot, v[*lt..*gt-1] == pivot and
+// v[*gt..hi-1] > pivot.
+static void partition(int v[], size_t lo, size_t hi, size_t *lt, size_t *gt) {
+  size_t a, b, c, d, s;
+
+  swap(v, lo, choose_pivot(v, lo, hi));
+  int pivot = v[lo];
+
+  // Elements equal to pivot are parked at both ends: v[lo..a-1] and
+  // v[d+1..hi-1]; v[a..b-1] < pivot and v[c+1..d] > pivot
+  a = b = lo + 1;
+  c = d = hi - 1;
+  for (;;) {
+    for (; b <= c && v[b] <= pivot; b++) {
+      if (v[b] == pivot) {
+        swap(v, a++, b);
+      }
+    }
+    for (; b <= c && v[c] >= pivot; c--) {
+      if (v[c] == pivot) {
+        swap(v, c, d--);
+      }
+    }
+    if (b > c) {
+      break;
+    }
+    swap(v, b++, c--);
+  }
+
+  // Move the parked equal elements to the middle
+  for (s = a - lo < b - a ? a - lo : b - a; s > 0; s--) {
+    swap(v, lo + s - 1, b - s);
+  }
+  for (s = d - c < hi - 1 - d ? d - c : hi - 1 - d; s > 0; s--) {
+    swap(v, b + s - 1, hi - s);
+  }
+  *lt = lo + (b - a);
+  *gt = hi - (d - c);
+}
+
+static void finish(Pool *pool, size_t count) {
+  atomic_fetch_sub_explicit(&pool->remaining, count, memory_order_relaxed);
+}
+
+// Sort v[task.lo..task.hi-1]: keep the larger side of every partition, and
+// hand the smaller one to the deque if it is at least GRAIN elements
+static void run_task(Worker *worker, Task task) {
+  Pool *pool = worker->pool;
+  int *v = pool->v;
+  size_t lo = task.lo, hi = task.hi;
+  int depth = task.depth;
+
+  while (hi - lo > CUTOFF) {
+    if (depth-- == 0) { // pivots keep going bad
+      heap_sort(v + lo, hi - lo);
+      finish(pool, hi - lo);
+      return;
+    }
+
+    size_t lt, gt;
+    partition(v, lo, hi, &lt, &gt);
+    finish(pool, gt - lt);
+
+    Task smaller;
+    if (lt - lo < hi - gt) {
+      smaller = (Task){lo, lt, depth};
+      lo = gt;
+    } else {
+      smaller = (Task){gt, hi, depth};
+      hi = lt;
+    }
+    if (smaller.hi - smaller.lo >= GRAIN) {
+      push_task(&pool->deques[worker->id], smaller);
+    } else if (smaller.hi > smaller.lo) {
+      run_task(worker, smaller); // depth stays O(log n): it is the smaller
+    }
+  }
+  if (!sort_network(v + lo, hi - lo)) {
+    insertion_sort(v, lo, hi);
+  }
+  finish(pool, hi - lo);
+}
+
+// Steal from the other workers, starting at a random one
+static int steal_task(Worker *worker, Task *task) {
+  Pool *pool = worker->pool;
+
+  worker->seed ^= worker->seed << 13;
+  worker->seed ^= worker->seed >> 17;
+  worker->seed ^= worker->seed << 5;
+  int start = worker->seed % pool->threads;
+
+  for (int i = 0; i < pool->threads; i++) {
+    int victim = (start + i) % pool->threads;
+    if (victim != worker->id && take_task(&pool->deques[victim], task, 1)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void *worker_main(void *arg) {
+  Worker *worker = arg;
+  Pool *pool = worker->pool;
+  Task task;
+
+  while (atomic_load_explicit(&pool->remaining, memory_order_relaxed) > 0) {
+    if (take_task(&pool->deques[worker->id], &task, 0) ||
+        steal_task(worker, &task)) {
+      run_task(worker, task);
+    } else {
+      sched_yield(); // nothing to do until someone splits off more work
+    }
+  }
+  return NULL;
+}
+
+// Sort v[0]...v[n-1] into increasing order using threads threads, the
+// calling thread being one of them
+void parallel_sort(int v[], size_t n, int threads) {
+  Pool pool;
+  pthread_t tids[MAX_THREADS];
+  Worker workers[MAX_THREADS];
+  int depth = 0;
+
+  if (threads < 1) {
+    threads = 1;
+  } else if (threads > MAX_THREADS) {
+    threads = MAX_THREADS;
+  }
+  for (size_t m = n; m > 1; m >>= 1) {
+    depth += 2; // 2 * floor(log2(n)), as in introsort
+  }
+
+  pool.v = v;
+  pool.threads = threads;
+  atomic_init(&pool.remaining, n);
+  for (int i = 0; i < threads; i++) {
+    deque_init(&pool.deques[i]);
+    workers[i] = (Worker){&pool, i, 2463534242u + 97u * i};
+  }
+  if (n > 0) {
+    push_task(&pool.deques[0], (Task){0, n, depth});
+  }
+
+  for (int i = 1; i < threads; i++) {
+    pthread_create(&tids[i], NULL, worker_main, &workers[i]);
+  }
+  worker_main(&workers[0]);
+  for (int i = 1; i < threads; i++) {
+    pthread_join(tids[i], NULL);
+  }
+
+  for (int i = 0; i < threads; i++) {
+    deque_destroy(&pool.deques[i]);
+  }
+}
+
+static double elapsed(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Sort the same n random ints with 1, 2, 4, ... max_threads threads
+void benchmark(size_t n, int max_threads) {
+  int *numbers = malloc(n * sizeof(int));
+  int *v = malloc(n * sizeof(int));
+  struct timespec start;
+  double base = 0;
+
+  if (numbers == NULL || v == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+  srand(1);
+  for (size_t i = 0; i < n; i++) {
+    numbers[i] = rand();
+  }
+
+  printf("%zu values\nthreads  seconds  speedup\n", n);
+  for (int threads = 1;; threads *= 2) {
+    if (threads > max_threads) {
+      threads = max_threads; // always finish with max_threads itself
+    }
+    memcpy(v, numbers, n * sizeof(int));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    parallel_sort(v, n, threads);
+    double secs = elapsed(&start);
+
+    int sorted = 1;
+    for (size_t i = 1; i < n; i++) {
+      sorted &= v[i - 1] <= v[i];
+    }
+    if (threads == 1) {
+      base = secs;
+    }
+    printf("%7d  %7.3f  %7.2f%s\n", threads, secs, base / secs,
+           sorted ? "" : "  NOT SORTED");
+    if (threads == max_threads) {
+      break;
+    }
+  }
+
+  free(v);
+  free(numbers);
+}
+
+int main(int argc, char *argv[]) {
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+  int max_threads =
+      argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+  if (max_threads < 1 || max_threads > MAX_THREADS) {
+    fprintf(stderr, "max_threads must be between 1 and %d\n", MAX_THREADS);
+    return EXIT_FAILURE;
+  }
+
+  benchmark(n, max_threads);
+  return 0;
+}
@@ -17,6 +17,8 @@
 #include <stdlib.h>
 #include <time.h>
 
+#include "sort_network.h"
+
 /* printd: print n in decimal */
 void printd(int n) {
 	if (n < 0) {
@@ -44,29 +46,156 @@ void printd(int n) {
  * elements, it doesn't need any sorting; this stops the recursion.
  */
 
-// Here's an example of this quicksort using middle element of each subarray for partitioning
+/***
+ * The version in the book takes the middle element as the partition element
+ * and recurses on both subsets. That is quadratic on inputs built to defeat
+ * the middle element, and on arrays with many equal values, since every
+ * equal element lands in the same subset; the recursion can then get deep
+ * enough to overflow the stack. The version here is an introspective sort,
+ * which keeps the shape of quicksort but guards each of those cases:
+ *
+ * - the partition element is the median of three elements, or for large
+ *   subarrays the median of three such medians (the "ninther");
+ * - the subarray is split in three parts - less than, equal to and greater
+ *   than the partition element - so equal values are finished in one pass;
+ * - subarrays of at most CUTOFF elements are left to the branch-free sorting
+ *   network of sort_network.h where the CPU has AVX2, and to insertion sort
+ *   otherwise; either is faster than quicksort on so few elements;
+ * - only the smaller part is sorted by a recursive call, the larger one by
+ *   going around the loop again, so the depth is at most log2(n);
+ * - if partitioning has not shrunk the subarray after about 2 log2(n)
+ *   rounds, the pivots are bad and the rest is sorted with heapsort, which is
+ *   O(n log n) on any input.
+ */
+
+#define CUTOFF 24	/* subarrays this small go to the leaf sort */
+
+/* insertion_sort: sort v[left]...v[right] by shifting larger elements up */
+static void insertion_sort(int v[], int left, int right) {
+	int i, j, temp;
+
+	for (i = left + 1; i <= right; i++) {
+		temp = v[i];
+		for (j = i; j > left && v[j - 1] > temp; j--)
+			v[j] = v[j - 1];
+		v[j] = temp;
+	}
+}
+
+/* sift_down: restore the heap below v[root] in the heap v[0]...v[n-1] */
+static void sift_down(int v[], int root, int n) {
+	int child, temp = v[root];
+
+	while ((child = 2 * root + 1) < n) {
+		if (child + 1 < n && v[child + 1] > v[child])
+			child++;		/* larger of the two children */
+		if (v[child] <= temp)
+			break;
+		v[root] = v[child];
+		root = child;
+	}
+	v[root] = temp;
+}
+
+/* heap_sort: sort v[left]...v[right], in O(n log n) time on any input */
+static void heap_sort(int v[], int left, int right) {
+	int n = right - left + 1, i;
+	void swap(int v[], int i, int j);
+
+	v += left;			/* index the range from 0 */
+	for (i = n / 2 - 1; i >= 0; i--)
+		sift_down(v, i, n);
+	for (i = n - 1; i > 0; i--) {
+		swap(v, 0, i);		/* move the largest to its place */
+		sift_down(v, 0, i);
+	}
+}
+
+/* median3: index of the median of v[a], v[b] and v[c] */
+static int median3(int v[], int a, int b, int c) {
+	if (v[a] < v[b])
+		return v[b] < v[c] ? b : (v[a] < v[c] ? c : a);
+	else
+		return v[a] < v[c] ? a : (v[b] < v[c] ? c : b);
+}
+
+/* choose_pivot: index of the partition element for v[left]...v[right] */
+static int choose_pivot(int v[], int left, int right) {
+	int n = right - left + 1, mid = left + n / 2, step;
+
+	if (n < 128)
+		return median3(v, left, mid, right);
+	step = n / 8;			/* ninther: median of three medians */
+	return median3(v, median3(v, left, left + step, left + 2 * step),
+	    median3(v, mid - step, mid, mid + step),
+	    median3(v, right - 2 * step, right - step, right));
+}
+
+/* introsort: sort v[left]...v[right], at most depth more partitions deep */
+static void introsort(int v[], int left, int right, int depth) {
+	int a, b, c, d, pivot, s;
+	void swap(int v[], int i, int j);
+
+	while (right - left >= CUTOFF) {
+		if (depth-- == 0) {		/* pivots keep going bad */
+			heap_sort(v, left, right);
+			return;
+		}
+		swap(v, left, choose_pivot(v, left, right));
+		pivot = v[left];
+
+		/* partition, parking elements equal to pivot at both ends:
+		   v[left..a-1] == pivot, v[a..b-1] < pivot,
+		   v[c+1..d] > pivot, v[d+1..right] == pivot */
+		a = b = left + 1;
+		c = d = right;
+		for (;;) {
+			for (; b <= c && v[b] <= pivot; b++)
+				if (v[b] == pivot)
+					swap(v, a++, b);
+			for (; b <= c && v[c] >= pivot; c--)
+				if (v[c] == pivot)
+					swap(v, c, d--);
+			if (b > c)
+				break;
+			swap(v, b++, c--);
+		}
+
+		/* move the equal elements from the ends to the middle */
+		for (s = a - left < b - a ? a - left : b - a; s > 0; s--)
+			swap(v, left + s - 1, b - s);
+		for (s = d - c < right - d ? d - c : right - d; s > 0; s--)
+			swap(v, b + s - 1, right - s + 1);
+		a = left + (b - a);		/* v[a..d] now equal pivot */
+		d = right - (d - c);
+
+		/* recurse into the smaller side, loop on the larger */
+		if (a - left < right - d) {
+			introsort(v, left, a - 1, depth);
+			left = d + 1;
+		} else {
+			introsort(v, d + 1, right, depth);
+			right = a - 1;
+		}
+	}
+	if (!sort_network(v + left, right - left + 1))
+		insertion_sort(v, left, right);
+}
 
 /* qsort: sort v[left]...v[right] into increasing order */
 void qsort_(int v[], int left, int right) {
-	int i, last;
-	void swap(int v[], int i, int j);
+	int depth = 0, n;
 
-	if (left >= right)			/* do nothing if array contains */
-		return;				/* fewer than two elements */
-	swap(v, left, (left + right) / 2);	/* move partition elem */
-	last = left;
-						/* to v[0] */
-	for (i = left + 1; i <= right; i++)	/* partition */
-		if (v[i] < v[left])
-			swap(v, ++last, i);
-	swap(v, left, last);			/* restore partition elem */
-	qsort_(v, left, last - 1);
-	qsort_(v, last + 1, right);
+	for (n = right - left + 1; n > 1; n >>= 1)
+		depth += 2;			/* 2 * floor(log2(n)) */
+	if (left < right)
+		introsort(v, left, right, depth);
 }
 
 /***
  * Swapping operation was moved to a seperate function swap because it occurs
- * three times in qsort.
+ * several times in the sort. It is small enough that the compiler inlines it
+ * into the partition loop, so the call costs nothing at run time.
  */
 
 /* swap: interchange v[i] and v[j] */
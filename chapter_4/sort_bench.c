@@ -0,0 +1,302 @@
+/*
+ * Benchmark of every int array sort in the repository
+ *
+ * Each sort runs on each input distribution at sizes 10^2, 10^3, ... up to
+ * MAX_SIZE. One line of CSV goes to stdout per run:
+ *
+ *   algorithm,distribution,size,ns_per_element,repetitions,ok
+ *
+ * so results can be loaded into a spreadsheet or diffed against an earlier
+ * run to spot regressions. Progress goes to stderr. Small sizes are sorted
+ * repeatedly, on a fresh copy of the same input each time, until at least
+ * MIN_SECONDS of sorting is measured; ns_per_element is the mean. ok is 1
+ * if the output matched the input as sorted by libc qsort().
+ *
+ * Distributions:
+ *   uniform     random 32-bit values
+ *   sorted      0, 1, 2, ...
+ *   reverse     n, n-1, n-2, ...
+ *   organ-pipe  0, 1, ..., n/2, ..., 1, 0
+ *   appended    0, 1, 2, ... with the last 1% replaced by random values
+ *   few-unique  random values among 16 distinct ones
+ *   zipf        value k with probability proportional to 1/k (s = 1) over
+ *               min(n, ZIPF_VALUES) values, so a few values dominate
+ *
+ * The sorts live in files that have a main() of their own, so each of those
+ * is compiled on its own with main (and any clashing name) renamed:
+ *
+ *   cc -O2 -c -Dmain=array_main -Dbenchmark=array_benchmark \
+ *      -Dprinta=array_printa ../chapter_2/array.c
+ *   cc -O2 -c -Datoi=loops_atoi ../chapter_3/loops.c
+ *   cc -O2 -c -Dmain=recursion_main recursion.c
+ *   cc -O2 -c -pthread -Dmain=parallel_main -Dbenchmark=parallel_benchmark \
+ *      parallel_sort.c
+ *   cc -O2 -pthread sort_bench.c array.o loops.o recursion.o parallel_sort.o
+ *
+ * Usage: ./a.out [-n MAX_SIZE] [-a ALGORITHM] [-d DISTRIBUTION]
+ *        (MAX_SIZE defaults to 10^7; -a and -d pick one of each)
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sort_generic.h"
+
+#define MIN_SECONDS 0.2      // least sorting time measured per line
+#define QUADRATIC_MAX 30000  // largest size the O(n^2) sorts are given
+#define SHELLSORT_MAX 10000000
+#define ZIPF_VALUES 100000
+
+// From chapter_2/array.c
+void bubble_sort(int arr[], const int size);
+void selection_sort(int arr[], int n);
+void radix_sort(int arr[], size_t n);
+
+// From chapter_3/loops.c
+enum gap_sequence { SHELL_GAPS, CIURA_GAPS, TOKUDA_GAPS };
+void shellsort(int v[], int n);
+void shellsort_gaps(int v[], int n, enum gap_sequence seq);
+
+// From recursion.c and parallel_sort.c
+void qsort_(int v[], int left, int right);
+void parallel_sort(int v[], size_t n, int threads);
+
+DEFINE_SORT(ints, int, int, SORT_KEY_SELF, SORT_LESS)
+DEFINE_STABLE_SORT(ints, int, int, SORT_KEY_SELF, SORT_LESS)
+
+typedef struct {
+  const char *name;
+  void (*sort)(int v[], size_t n);
+  size_t max_size; // larger inputs are skipped
+} Algorithm;
+
+typedef struct {
+  const char *name;
+  void (*fill)(int v[], size_t n);
+} Distribution;
+
+static int threads = 1; // for parallel_sort, set from the CPU count
+
+static int compare_ints(const void *a, const void *b) {
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+static void run_bubble(int v[], size_t n) { bubble_sort(v, (int)n); }
+static void run_selection(int v[], size_t n) { selection_sort(v, (int)n); }
+static void run_shellsort(int v[], size_t n) { shellsort(v, (int)n); }
+static void run_shell_halving(int v[], size_t n) {
+  shellsort_gaps(v, (int)n, SHELL_GAPS);
+}
+static void run_shell_ciura(int v[], size_t n) {
+  shellsort_gaps(v, (int)n, CIURA_GAPS);
+}
+static void run_shell_tokuda(int v[], size_t n) {
+  shellsort_gaps(v, (int)n, TOKUDA_GAPS);
+}
+static void run_qsort_(int v[], size_t n) { qsort_(v, 0, (int)n - 1); }
+static void run_radix(int v[], size_t n) { radix_sort(v, n); }
+static void run_parallel(int v[], size_t n) { parallel_sort(v, n, threads); }
+static void run_generic(int v[], size_t n) { ints_sort(v, n); }
+static void run_stable(int v[], size_t n) { ints_stable_sort(v, n); }
+static void run_libc_qsort(int v[], size_t n) {
+  qsort(v, n, sizeof(int), compare_ints);
+}
+
+static const Algorithm algorithms[] = {
+    {"bubble_sort", run_bubble, QUADRATIC_MAX},
+    {"selection_sort", run_selection, QUADRATIC_MAX},
+    {"shellsort", run_shellsort, SHELLSORT_MAX},
+    {"shellsort_halving", run_shell_halving, SHELLSORT_MAX},
+    {"shellsort_ciura", run_shell_ciura, SHELLSORT_MAX},
+    {"shellsort_tokuda", run_shell_tokuda, SHELLSORT_MAX},
+    {"qsort_", run_qsort_, SIZE_MAX},
+    {"radix_sort", run_radix, SIZE_MAX},
+    {"parallel_sort", run_parallel, SIZE_MAX},
+    {"sort_generic", run_generic, SIZE_MAX},
+    {"stable_sort", run_stable, SIZE_MAX},
+    {"libc_qsort", run_libc_qsort, SIZE_MAX},
+};
+
+static uint64_t random_state = 88172645463325252ULL;
+
+static uint64_t next_random(void) {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 7;
+  random_state ^= random_state << 17;
+  return random_state;
+}
+
+static void fill_uniform(int v[], size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    v[i] = (int)(uint32_t)next_random();
+  }
+}
+
+static void fill_sorted(int v[], size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    v[i] = (int)i;
+  }
+}
+
+static void fill_reverse(int v[], size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    v[i] = (int)(n - i);
+  }
+}
+
+static void fill_organ_pipe(int v[], size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    v[i] = (int)(i < n / 2 ? i : n - i);
+  }
+}
+
+// A sorted array that new records were appended to
+static void fill_appended(int v[], size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    v[i] = i < n - n / 100 ? (int)i : (int)(next_random() % n);
+  }
+}
+
+static void fill_few_unique(int v[], size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    v[i] = (int)(next_random() % 16) * 1000003;
+  }
+}
+
+// Inverse transform sampling: find the first value whose cumulative
+// probability reaches a uniform random number
+static void fill_zipf(int v[], size_t n) {
+  size_t values = n < ZIPF_VALUES ? n : ZIPF_VALUES;
+  double *cdf = malloc(values * sizeof(double));
+  double sum = 0;
+
+  if (cdf == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+  for (size_t k = 0; k < values; k++) {
+    sum += 1.0 / (k + 1);
+    cdf[k] = sum;
+  }
+  for (size_t i = 0; i < n; i++) {
+    double u = (next_random() >> 11) * (1.0 / (1ULL << 53)) * sum;
+    size_t lo = 0, hi = values - 1;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (cdf[mid] < u) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    v[i] = (int)lo;
+  }
+  free(cdf);
+}
+
+static const Distribution distributions[] = {
+    {"uniform", fill_uniform},       {"sorted", fill_sorted},
+    {"reverse", fill_reverse},       {"organ-pipe", fill_organ_pipe},
+    {"appended", fill_appended},     {"few-unique", fill_few_unique},
+    {"zipf", fill_zipf},
+};
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static double elapsed(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// 1 if v[0..n-1] matches sorted, the input as sorted by libc qsort()
+static int check(const int v[], const int sorted[], size_t n) {
+  return memcmp(v, sorted, n * sizeof(int)) == 0;
+}
+
+// Time one algorithm on input and print its CSV line
+static void measure(const Algorithm *algorithm, const char *distribution,
+                    const int input[], const int sorted[], int work[],
+                    size_t n) {
+  struct timespec start;
+  double secs = 0;
+  long reps = 0;
+  int ok = 1;
+
+  do {
+    memcpy(work, input, n * sizeof(int));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    algorithm->sort(work, n);
+    secs += elapsed(&start);
+    reps++;
+    if (reps == 1) {
+      ok = check(work, sorted, n);
+    }
+  } while (secs < MIN_SECONDS);
+
+  printf("%s,%s,%zu,%.3f,%ld,%d\n", algorithm->name, distribution, n,
+         secs * 1e9 / ((double)n * reps), reps, ok);
+  fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+  size_t max_size = 10000000;
+  const char *only_algorithm = NULL, *only_distribution = NULL;
+
+  for (int i = 1; i < argc; i += 2) {
+    if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+      max_size = strtoul(argv[i + 1], NULL, 10);
+    } else if (i + 1 < argc && strcmp(argv[i], "-a") == 0) {
+      only_algorithm = argv[i + 1];
+    } else if (i + 1 < argc && strcmp(argv[i], "-d") == 0) {
+      only_distribution = argv[i + 1];
+    } else {
+      fprintf(stderr,
+              "usage: %s [-n MAX_SIZE] [-a ALGORITHM] [-d DISTRIBUTION]\n",
+              argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (max_size > 100000000) {
+    max_size = 100000000; // sizes must fit in an int for the older sorts
+  }
+  threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+  int *input = malloc(max_size * sizeof(int));
+  int *sorted = malloc(max_size * sizeof(int));
+  int *work = malloc(max_size * sizeof(int));
+  if (input == NULL || sorted == NULL || work == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("algorithm,distribution,size,ns_per_element,repetitions,ok\n");
+  for (size_t d = 0; d < COUNT(distributions); d++) {
+    if (only_distribution && strcmp(only_distribution, distributions[d].name)) {
+      continue;
+    }
+    for (size_t n = 100; n <= max_size; n *= 10) {
+      distributions[d].fill(input, n);
+      memcpy(sorted, input, n * sizeof(int));
+      qsort(sorted, n, sizeof(int), compare_ints);
+      fprintf(stderr, "%s, %zu values\n", distributions[d].name, n);
+
+      for (size_t a = 0; a < COUNT(algorithms); a++) {
+        if ((only_algorithm && strcmp(only_algorithm, algorithms[a].name)) ||
+            n > algorithms[a].max_size) {
+          continue;
+        }
+        measure(&algorithms[a], distributions[d].name, input, sorted, work, n);
+      }
+    }
+  }
+
+  free(work);
+  free(sorted);
+  free(input);
+  return 0;
+}
@@ -0,0 +1,180 @@
+#include "sort_generic.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+  uint64_t id;
+  double score;
+  char name[16];
+} Record;
+
+static inline double record_score(const Record *r) { return r->score; }
+static inline uint64_t record_id(const Record *r) { return r->id; }
+
+// Plain numbers, and records by one field each: the whole record moves with
+// its key
+DEFINE_SORT(doubles, double, double, SORT_KEY_SELF, SORT_LESS)
+DEFINE_SORT(u64s, uint64_t, uint64_t, SORT_KEY_SELF, SORT_LESS)
+DEFINE_SORT(by_score, Record, double, record_score, SORT_GREATER)
+DEFINE_SORT(by_id, Record, uint64_t, record_id, SORT_LESS)
+
+// Stable versions: equal keys keep their order, and runs in the input are
+// used as they are
+DEFINE_STABLE_SORT(u64s, uint64_t, uint64_t, SORT_KEY_SELF, SORT_LESS)
+DEFINE_STABLE_SORT(by_score, Record, double, record_score, SORT_GREATER)
+
+static int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static int compare_u64s(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static int compare_ids(const void *a, const void *b) {
+  return compare_u64s(&((const Record *)a)->id, &((const Record *)b)->id);
+}
+
+static uint64_t next_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+static double elapsed(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void *allocate(size_t size) {
+  void *p = malloc(size ? size : 1);
+  if (p == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+  return p;
+}
+
+// Time the generated sort against qsort() for n doubles, n 64-bit keys and
+// n records sorted by id, then the stable sort against the generated one on
+// nearly sorted keys
+void benchmark(size_t n) {
+  double *d1 = allocate(n * sizeof(double)), *d2 = allocate(n * sizeof(double));
+  uint64_t *k1 = allocate(n * sizeof(uint64_t));
+  uint64_t *k2 = allocate(n * sizeof(uint64_t));
+  Record *r1 = allocate(n * sizeof(Record)), *r2 = allocate(n * sizeof(Record));
+  uint64_t state = 88172645463325252ULL;
+  struct timespec start;
+  double generated, libc;
+
+  for (size_t i = 0; i < n; i++) {
+    k1[i] = k2[i] = next_random(&state);
+    d1[i] = d2[i] = (double)(k1[i] >> 11) / (1ULL << 53);
+    r1[i] = r2[i] = (Record){k1[i] >> 8, d1[i], "x"};
+  }
+
+  printf("%zu elements\n               generated ns  qsort ns\n", n);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  doubles_sort(d1, n);
+  generated = elapsed(&start);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  qsort(d2, n, sizeof(double), compare_doubles);
+  libc = elapsed(&start);
+  printf("double          %12.1f  %8.1f%s\n", generated * 1e9 / n,
+         libc * 1e9 / n, memcmp(d1, d2, n * sizeof(double)) ? "  WRONG" : "");
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  u64s_sort(k1, n);
+  generated = elapsed(&start);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  qsort(k2, n, sizeof(uint64_t), compare_u64s);
+  libc = elapsed(&start);
+  printf("uint64_t        %12.1f  %8.1f%s\n", generated * 1e9 / n,
+         libc * 1e9 / n, memcmp(k1, k2, n * sizeof(uint64_t)) ? "  WRONG" : "");
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  by_id_sort(r1, n);
+  generated = elapsed(&start);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  qsort(r2, n, sizeof(Record), compare_ids);
+  libc = elapsed(&start);
+  int same = 1;
+  for (size_t i = 0; i < n; i++) {
+    same &= r1[i].id == r2[i].id;
+  }
+  printf("Record by id    %12.1f  %8.1f%s\n", generated * 1e9 / n,
+         libc * 1e9 / n, same ? "" : "  WRONG");
+
+  // Nearly sorted: the sorted keys with 1% new random keys appended
+  for (size_t i = n - n / 100; i < n; i++) {
+    k1[i] = next_random(&state);
+  }
+  memcpy(k2, k1, n * sizeof(uint64_t));
+  printf("\nsorted + 1%% appended      stable ns  introsort ns\n");
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  u64s_stable_sort(k1, n);
+  generated = elapsed(&start);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  u64s_sort(k2, n);
+  libc = elapsed(&start);
+  printf("uint64_t        %17.1f  %12.1f%s\n", generated * 1e9 / n,
+         libc * 1e9 / n, memcmp(k1, k2, n * sizeof(uint64_t)) ? "  WRONG" : "");
+
+  free(r2);
+  free(r1);
+  free(k2);
+  free(k1);
+  free(d2);
+  free(d1);
+}
+
+int main(int argc, char *argv[]) {
+  // ./sort_generic N compares the generated sorts with qsort() on N elements
+  if (argc > 1) {
+    benchmark(strtoul(argv[1], NULL, 10));
+    return 0;
+  }
+
+  double prices[] = {2.40, 0.99, 1.30, 5.75, 0.25, 1.30};
+  doubles_sort(prices, 6);
+  for (int i = 0; i < 6; i++) {
+    printf("%.2f ", prices[i]);
+  }
+  printf("\n");
+
+  Record players[] = {
+      {7, 88.5, "Seyfi"}, {3, 92.0, "Leyli"}, {9, 75.25, "Alice"},
+      {1, 92.0, "Bob"},   {5, 60.0, "Maximilian"},
+  };
+  by_score_sort(players, 5); // highest score first
+  for (int i = 0; i < 5; i++) {
+    printf("%-10s %6.2f (id %llu)\n", players[i].name, players[i].score,
+           (unsigned long long)players[i].id);
+  }
+
+  by_id_sort(players, 5);
+  printf("By id:");
+  for (int i = 0; i < 5; i++) {
+    printf(" %s", players[i].name);
+  }
+  printf("\n");
+
+  // Sorted by id already, so the stable sort keeps Bob (id 1) ahead of
+  // Leyli (id 3) on their equal score
+  by_score_stable_sort(players, 5);
+  printf("By score, then id:");
+  for (int i = 0; i < 5; i++) {
+    printf(" %s", players[i].name);
+  }
+  printf("\n");
+
+  return 0;
+}
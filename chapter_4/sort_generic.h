@@ -0,0 +1,465 @@
+/*
+ * Type-specialized sorts generated by a macro
+ *
+ *   DEFINE_SORT(name, T, K, key_fn, less_fn)
+ *
+ * expands to
+ *
+ *   void name_sort(T v[], size_t n);
+ *
+ * which sorts v[0]...v[n-1] into increasing order of key. key_fn is called as
+ * `K key_fn(const T *elem)` and extracts the sort key of an element - the
+ * element itself for plain numbers, one field for records - and less_fn is
+ * called as `int less_fn(K a, K b)`. Both are plain function (or macro) calls
+ * in the generated code, so the compiler inlines them into each
+ * instantiation. libc qsort() instead calls a comparator through a function
+ * pointer for every comparison and moves elements byte by byte, whatever
+ * their type.
+ *
+ * Sorting records by one field is the key+payload case: the record is moved
+ * as a whole (a struct assignment), while only its key is compared.
+ *
+ * The algorithm is the introsort of qsort_() in chapter_4/recursion.c:
+ * median-of-three pivots, insertion sort for small ranges, recursion into
+ * the smaller part only and heapsort if the pivots keep going bad, so it is
+ * O(n log n) in the worst case and needs O(log n) stack. It partitions in
+ * two, Hoare's way, which needs less_fn only and still splits runs of equal
+ * keys evenly. The sort is not stable, and less_fn must be a strict weak
+ * order: NaN keys, for one, leave the order unspecified.
+ *
+ *   DEFINE_STABLE_SORT(name, T, K, key_fn, less_fn)
+ *
+ * expands, with the same arguments, to
+ *
+ *   void name_stable_sort(T v[], size_t n);
+ *
+ * a stable merge sort that adapts to runs already in the input. It scans v
+ * for maximal ascending runs (strictly descending ones are reversed in
+ * place), extends runs shorter than SORT_GENERIC_MIN_RUN by insertion sort,
+ * and merges neighbouring runs in the order powersort picks from the run
+ * boundaries, which keeps the merges balanced. Each merge first gallops to
+ * skip the elements of either run that are already in place, then merges
+ * element by element until one run wins SORT_GENERIC_MIN_GALLOP times in a
+ * row, and from there moves whole stretches found by exponential search.
+ * Sorted input is one run and costs n - 1 comparisons; a sorted array with
+ * a few values appended is one run plus a short one, merged in O(log n)
+ * comparisons per appended value. Random input costs about n log2 n
+ * comparisons, as for any merge sort. It needs a buffer of n/2 elements,
+ * allocated on each call.
+ */
+#ifndef SORT_GENERIC_H
+#define SORT_GENERIC_H
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SORT_GENERIC_CUTOFF 16    // ranges this small go to insertion sort
+#define SORT_GENERIC_MIN_RUN 24   // shorter runs are extended by insertion
+#define SORT_GENERIC_MIN_GALLOP 7 // wins in a row before a merge gallops
+
+// Ready-made key extractors and orders
+#define SORT_KEY_SELF(p) (*(p)) // the element is its own key
+#define SORT_LESS(a, b) ((a) < (b))
+#define SORT_GREATER(a, b) ((a) > (b)) // for decreasing order
+
+#define DEFINE_SORT(name, T, K, key_fn, less_fn)                              \
+  static inline int name##_less(const T *a, const T *b) {                     \
+    K ka = key_fn(a);                                                         \
+    K kb = key_fn(b);                                                         \
+    return less_fn(ka, kb);                                                   \
+  }                                                                           \
+                                                                              \
+  static inline void name##_swap(T *a, T *b) {                                \
+    T temp = *a;                                                              \
+    *a = *b;                                                                  \
+    *b = temp;                                                                \
+  }                                                                           \
+                                                                              \
+  static inline void name##_insertion(T v[], size_t n) {                      \
+    for (size_t i = 1; i < n; i++) {                                          \
+      T temp = v[i];                                                          \
+      size_t j = i;                                                           \
+      for (; j > 0 && name##_less(&temp, &v[j - 1]); j--) {                   \
+        v[j] = v[j - 1];                                                      \
+      }                                                                       \
+      v[j] = temp;                                                            \
+    }                                                                         \
+  }                                                                           \
+                                                                              \
+  static inline void name##_sift_down(T v[], size_t root, size_t n) {         \
+    T temp = v[root];                                                         \
+    size_t child;                                                             \
+                                                                              \
+    while ((child = 2 * root + 1) < n) {                                      \
+      if (child + 1 < n && name##_less(&v[child], &v[child + 1])) {           \
+        child++;                                                              \
+      }                                                                       \
+      if (!name##_less(&temp, &v[child])) {                                   \
+        break;                                                                \
+      }                                                                       \
+      v[root] = v[child];                                                     \
+      root = child;                                                           \
+    }                                                                         \
+    v[root] = temp;                                                           \
+  }                                                                           \
+                                                                              \
+  static inline void name##_heap_sort(T v[], size_t n) {                      \
+    for (size_t i = n / 2; i-- > 0;) {                                        \
+      name##_sift_down(v, i, n);                                              \
+    }                                                                         \
+    for (size_t i = n - 1; i > 0; i--) {                                      \
+      name##_swap(&v[0], &v[i]);                                              \
+      name##_sift_down(v, 0, i);                                              \
+    }                                                                         \
+  }                                                                           \
+                                                                              \
+  static void name##_introsort(T v[], size_t n, int depth) {                  \
+    while (n > SORT_GENERIC_CUTOFF) {                                         \
+      if (depth-- == 0) { /* pivots keep going bad */                         \
+        name##_heap_sort(v, n);                                               \
+        return;                                                               \
+      }                                                                       \
+                                                                              \
+      /* Order v[0], v[mid] and v[n-1], then move the median to v[0]; the */  \
+      /* largest of the three at v[n-1] stops the first scan from the left */ \
+      size_t mid = n / 2, i = 0, j = n;                                       \
+      if (name##_less(&v[mid], &v[0])) {                                      \
+        name##_swap(&v[mid], &v[0]);                                          \
+      }                                                                       \
+      if (name##_less(&v[n - 1], &v[mid])) {                                  \
+        name##_swap(&v[n - 1], &v[mid]);                                      \
+      }                                                                       \
+      if (name##_less(&v[mid], &v[0])) {                                      \
+        name##_swap(&v[mid], &v[0]);                                          \
+      }                                                                       \
+      name##_swap(&v[0], &v[mid]);                                            \
+                                                                              \
+      /* Hoare partition around v[0]: both scans stop on equal keys */        \
+      for (;;) {                                                              \
+        while (name##_less(&v[++i], &v[0]))                                   \
+          ;                                                                   \
+        while (name##_less(&v[0], &v[--j]))                                   \
+          ;                                                                   \
+        if (i >= j) {                                                         \
+          break;                                                              \
+        }                                                                     \
+        name##_swap(&v[i], &v[j]);                                            \
+      }                                                                       \
+      name##_swap(&v[0], &v[j]); /* pivot to its final place */               \
+                                                                              \
+      /* Recurse into the smaller side, loop on the larger */                 \
+      if (j < n - j - 1) {                                                    \
+        name##_introsort(v, j, depth);                                        \
+        v += j + 1;                                                           \
+        n -= j + 1;                                                           \
+      } else {                                                                \
+        name##_introsort(v + j + 1, n - j - 1, depth);                        \
+        n = j;                                                                \
+      }                                                                       \
+    }                                                                         \
+    name##_insertion(v, n);                                                   \
+  }                                                                           \
+                                                                              \
+  static inline void name##_sort(T v[], size_t n) {                           \
+    int depth = 0;                                                            \
+    for (size_t m = n; m > 1; m >>= 1) {                                      \
+      depth += 2; /* 2 * floor(log2(n)) */                                    \
+    }                                                                         \
+    name##_introsort(v, n, depth);                                            \
+  }
+
+// Powersort's priority for the boundary between the runs v[a..b-1] and
+// v[b..c-1] of n: the depth of the first bit where the run midpoints,
+// as fractions of n, differ. Runs are merged deepest boundary first.
+static inline int sort_generic_power(size_t n, size_t a, size_t b, size_t c) {
+  size_t l = a + b, r = b + c; // twice the midpoints
+  int power = 0;
+
+  for (;;) {
+    power++;
+    l *= 2;
+    r *= 2;
+    int dl = l >= 2 * n, dr = r >= 2 * n;
+    if (dl != dr) {
+      return power;
+    }
+    if (dl) {
+      l -= 2 * n;
+      r -= 2 * n;
+    }
+  }
+}
+
+#define DEFINE_STABLE_SORT(name, T, K, key_fn, less_fn)                       \
+  static inline int name##_stable_less(const T *a, const T *b) {              \
+    K ka = key_fn(a);                                                         \
+    K kb = key_fn(b);                                                         \
+    return less_fn(ka, kb);                                                   \
+  }                                                                           \
+                                                                              \
+  /* 1 if key belongs after x: after equal elements too if after_equal */     \
+  static inline int name##_stable_after(const T *key, const T *x,             \
+                                        int after_equal) {                    \
+    return after_equal ? !name##_stable_less(key, x)                          \
+                       : name##_stable_less(x, key);                          \
+  }                                                                           \
+                                                                              \
+  /* Index in base[0..n-1] where key belongs, before or after equal */        \
+  /* elements. Probes 1, 3, 7, ... elements from the start or the end, */     \
+  /* then bisects, so it costs O(log d) for an answer d elements away. */     \
+  static inline size_t name##_stable_gallop(const T *key, const T *base,      \
+                                            size_t n, int after_equal,        \
+                                            int from_end) {                   \
+    size_t lo, hi, last = 0, ofs = 1;                                         \
+                                                                              \
+    if (!from_end) {                                                          \
+      if (n == 0 || !name##_stable_after(key, &base[0], after_equal)) {       \
+        return 0;                                                             \
+      }                                                                       \
+      while (ofs < n && name##_stable_after(key, &base[ofs], after_equal)) {  \
+        last = ofs;                                                           \
+        ofs = 2 * ofs + 1;                                                    \
+      }                                                                       \
+      lo = last + 1;                                                          \
+      hi = ofs < n ? ofs : n;                                                 \
+    } else {                                                                  \
+      if (n == 0 || name##_stable_after(key, &base[n - 1], after_equal)) {    \
+        return n;                                                             \
+      }                                                                       \
+      while (ofs < n &&                                                       \
+             !name##_stable_after(key, &base[n - 1 - ofs], after_equal)) {    \
+        last = ofs;                                                           \
+        ofs = 2 * ofs + 1;                                                    \
+      }                                                                       \
+      lo = ofs < n ? n - ofs : 0;                                             \
+      hi = n - 1 - last;                                                      \
+    }                                                                         \
+    while (lo < hi) {                                                         \
+      size_t mid = lo + (hi - lo) / 2;                                        \
+      if (name##_stable_after(key, &base[mid], after_equal)) {                \
+        lo = mid + 1;                                                         \
+      } else {                                                                \
+        hi = mid;                                                             \
+      }                                                                       \
+    }                                                                         \
+    return lo;                                                                \
+  }                                                                           \
+                                                                              \
+  static inline void name##_stable_move(T *dest, const T *src, size_t n) {    \
+    memmove(dest, src, n * sizeof(T));                                        \
+  }                                                                           \
+                                                                              \
+  /* Merge v[0..na-1] and v[na..na+nb-1], na <= nb, copying the left run */   \
+  /* to buf and filling v from the front */                                   \
+  static void name##_stable_merge_lo(T v[], size_t na, size_t nb, T buf[]) {  \
+    T *a = buf, *b = v + na;                                                  \
+    size_t i = 0, j = 0, k = 0;                                               \
+                                                                              \
+    memcpy(buf, v, na * sizeof(T));                                           \
+    while (i < na && j < nb) {                                                \
+      size_t wins_a = 0, wins_b = 0;                                          \
+                                                                              \
+      /* One element at a time until one side keeps winning */                \
+      while (i < na && j < nb && wins_a < SORT_GENERIC_MIN_GALLOP &&          \
+             wins_b < SORT_GENERIC_MIN_GALLOP) {                              \
+        if (name##_stable_less(&b[j], &a[i])) {                               \
+          v[k++] = b[j++];                                                    \
+          wins_b++;                                                           \
+          wins_a = 0;                                                         \
+        } else {                                                              \
+          v[k++] = a[i++];                                                    \
+          wins_a++;                                                           \
+          wins_b = 0;                                                         \
+        }                                                                     \
+      }                                                                       \
+                                                                              \
+      /* Gallop: move whole stretches found by searching */                   \
+      while (i < na && j < nb) {                                              \
+        size_t ca = name##_stable_gallop(&b[j], a + i, na - i, 1, 0);         \
+        name##_stable_move(v + k, a + i, ca);                                 \
+        i += ca;                                                              \
+        k += ca;                                                              \
+        if (i == na) {                                                        \
+          break;                                                              \
+        }                                                                     \
+        v[k++] = b[j++];                                                      \
+        if (j == nb) {                                                        \
+          break;                                                              \
+        }                                                                     \
+        size_t cb = name##_stable_gallop(&a[i], b + j, nb - j, 0, 0);         \
+        name##_stable_move(v + k, b + j, cb);                                 \
+        j += cb;                                                              \
+        k += cb;                                                              \
+        if (j == nb) {                                                        \
+          break;                                                              \
+        }                                                                     \
+        v[k++] = a[i++];                                                      \
+        if (ca < SORT_GENERIC_MIN_GALLOP && cb < SORT_GENERIC_MIN_GALLOP) {   \
+          break; /* stretches got short: back to one at a time */             \
+        }                                                                     \
+      }                                                                       \
+    }                                                                         \
+    /* What is left of b is already in place */                               \
+    name##_stable_move(v + k, a + i, na - i);                                 \
+  }                                                                           \
+                                                                              \
+  /* Merge v[0..na-1] and v[na..na+nb-1], nb < na, copying the right run */   \
+  /* to buf and filling v from the back */                                    \
+  static void name##_stable_merge_hi(T v[], size_t na, size_t nb, T buf[]) {  \
+    T *a = v, *b = buf;                                                       \
+    size_t i = na, j = nb, k = na + nb; /* counts left, not indices */        \
+                                                                              \
+    memcpy(buf, v + na, nb * sizeof(T));                                      \
+    while (i > 0 && j > 0) {                                                  \
+      size_t wins_a = 0, wins_b = 0;                                          \
+                                                                              \
+      while (i > 0 && j > 0 && wins_a < SORT_GENERIC_MIN_GALLOP &&            \
+             wins_b < SORT_GENERIC_MIN_GALLOP) {                              \
+        if (name##_stable_less(&b[j - 1], &a[i - 1])) {                       \
+          v[--k] = a[--i];                                                    \
+          wins_a++;                                                           \
+          wins_b = 0;                                                         \
+        } else {                                                              \
+          v[--k] = b[--j];                                                    \
+          wins_b++;                                                           \
+          wins_a = 0;                                                         \
+        }                                                                     \
+      }                                                                       \
+                                                                              \
+      while (i > 0 && j > 0) {                                                \
+        /* Elements of a that belong after b[j-1] */                          \
+        size_t ca = i - name##_stable_gallop(&b[j - 1], a, i, 1, 1);          \
+        k -= ca;                                                              \
+        i -= ca;                                                              \
+        name##_stable_move(v + k, a + i, ca);                                 \
+        if (i == 0) {                                                         \
+          break;                                                              \
+        }                                                                     \
+        v[--k] = b[--j];                                                      \
+        if (j == 0) {                                                         \
+          break;                                                              \
+        }                                                                     \
+        /* Elements of b that belong after a[i-1] */                          \
+        size_t cb = j - name##_stable_gallop(&a[i - 1], b, j, 0, 1);          \
+        k -= cb;                                                              \
+        j -= cb;                                                              \
+        name##_stable_move(v + k, b + j, cb);                                 \
+        if (j == 0) {                                                         \
+          break;                                                              \
+        }                                                                     \
+        v[--k] = a[--i];                                                      \
+        if (ca < SORT_GENERIC_MIN_GALLOP && cb < SORT_GENERIC_MIN_GALLOP) {   \
+          break;                                                              \
+        }                                                                     \
+      }                                                                       \
+    }                                                                         \
+    /* What is left of a is already in place */                               \
+    name##_stable_move(v, b, j);                                              \
+  }                                                                           \
+                                                                              \
+  /* Merge the neighbouring sorted runs v[0..na-1] and v[na..na+nb-1] */      \
+  static void name##_stable_merge(T v[], size_t na, size_t nb, T buf[]) {     \
+    /* Elements at the start of a and the end of b are already in place */    \
+    size_t skip = name##_stable_gallop(&v[na], v, na, 1, 0);                  \
+    v += skip;                                                                \
+    na -= skip;                                                               \
+    if (na == 0) {                                                            \
+      return;                                                                 \
+    }                                                                         \
+    nb = name##_stable_gallop(&v[na - 1], v + na, nb, 0, 1);                  \
+    if (nb == 0) {                                                            \
+      return;                                                                 \
+    }                                                                         \
+    if (na <= nb) {                                                           \
+      name##_stable_merge_lo(v, na, nb, buf);                                 \
+    } else {                                                                  \
+      name##_stable_merge_hi(v, na, nb, buf);                                 \
+    }                                                                         \
+  }                                                                           \
+                                                                              \
+  /* Length of the run at v[0..n-1], made ascending and at least */           \
+  /* SORT_GENERIC_MIN_RUN long (or n) */                                      \
+  static size_t name##_stable_run(T v[], size_t n) {                          \
+    size_t len = 1;                                                           \
+                                                                              \
+    if (n < 2) {                                                              \
+      return n;                                                               \
+    }                                                                         \
+    if (name##_stable_less(&v[1], &v[0])) {                                   \
+      /* Strictly descending, so reversing keeps equal elements in order */   \
+      while (len < n && name##_stable_less(&v[len], &v[len - 1])) {           \
+        len++;                                                                \
+      }                                                                       \
+      for (size_t lo = 0, hi = len - 1; lo < hi; lo++, hi--) {                \
+        T temp = v[lo];                                                       \
+        v[lo] = v[hi];                                                        \
+        v[hi] = temp;                                                         \
+      }                                                                       \
+    } else {                                                                  \
+      while (len < n && !name##_stable_less(&v[len], &v[len - 1])) {          \
+        len++;                                                                \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+    /* Insertion sort the next elements into a short run */                   \
+    size_t end = n < SORT_GENERIC_MIN_RUN ? n : SORT_GENERIC_MIN_RUN;         \
+    for (; len < end; len++) {                                                \
+      T temp = v[len];                                                        \
+      size_t j = len;                                                         \
+      for (; j > 0 && name##_stable_less(&temp, &v[j - 1]); j--) {            \
+        v[j] = v[j - 1];                                                      \
+      }                                                                       \
+      v[j] = temp;                                                            \
+    }                                                                         \
+    return len;                                                               \
+  }                                                                           \
+                                                                              \
+  static inline void name##_stable_sort(T v[], size_t n) {                    \
+    struct {                                                                  \
+      size_t start, len;                                                      \
+      int power; /* of the boundary after the run */                          \
+    } stack[2 * sizeof(size_t) * CHAR_BIT + 1];                               \
+    int top = 0;                                                              \
+    T *buf;                                                                   \
+                                                                              \
+    if (n < 2) {                                                              \
+      return;                                                                 \
+    }                                                                         \
+    buf = malloc((n / 2 + 1) * sizeof(T));                                    \
+    if (!buf) {                                                               \
+      fprintf(stderr, "Memory allocation failed!\n");                         \
+      exit(EXIT_FAILURE);                                                     \
+    }                                                                         \
+                                                                              \
+    size_t start = 0, len = name##_stable_run(v, n);                          \
+    while (start + len < n) {                                                 \
+      size_t next = start + len;                                              \
+      size_t next_len = name##_stable_run(v + next, n - next);                \
+      int power = sort_generic_power(n, start, next, next + next_len);        \
+                                                                              \
+      /* Merge the runs below whose boundaries are deeper in the tree */      \
+      while (top > 0 && stack[top - 1].power > power) {                       \
+        top--;                                                                \
+        name##_stable_merge(v + stack[top].start, stack[top].len, len, buf);  \
+        start = stack[top].start;                                             \
+        len += stack[top].len;                                                \
+      }                                                                       \
+      stack[top].start = start;                                               \
+      stack[top].len = len;                                                   \
+      stack[top].power = power;                                               \
+      top++;                                                                  \
+      start = next;                                                           \
+      len = next_len;                                                         \
+    }                                                                         \
+    while (top > 0) {                                                         \
+      top--;                                                                  \
+      name##_stable_merge(v + stack[top].start, stack[top].len, len, buf);    \
+      len += stack[top].len;                                                  \
+    }                                                                         \
+    free(buf);                                                                \
+  }
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * Benchmark of the sorting networks in sort_network.h against insertion sort,
+ * the usual base case of quicksort, on the block sizes a leaf sees
+ *
+ * Build: cc -O2 sort_network.c
+ * Usage: ./a.out [BLOCKS]   sort BLOCKS random blocks of each size
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sort_network.h"
+
+static void insertion_sort(int v[], int n) {
+  for (int i = 1; i < n; i++) {
+    int temp = v[i], j = i;
+    for (; j > 0 && v[j - 1] > temp; j--) {
+      v[j] = v[j - 1];
+    }
+    v[j] = temp;
+  }
+}
+
+static double elapsed(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int compare_ints(const void *a, const void *b) {
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+// Sort blocks consecutive blocks of n values with both methods; returns 0 if
+// the network gave a different result
+int benchmark(int n, int blocks) {
+  size_t total = (size_t)n * blocks;
+  int *numbers = malloc(total * sizeof(int));
+  int *by_insertion = malloc(total * sizeof(int));
+  int *by_network = malloc(total * sizeof(int));
+  struct timespec start;
+
+  if (numbers == NULL || by_insertion == NULL || by_network == NULL) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+  for (size_t i = 0; i < total; i++) {
+    numbers[i] = rand() - RAND_MAX / 2;
+    by_insertion[i] = by_network[i] = numbers[i];
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int b = 0; b < blocks; b++) {
+    insertion_sort(by_insertion + (size_t)b * n, n);
+  }
+  double insertion_secs = elapsed(&start);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int b = 0; b < blocks; b++) {
+    sort_network(by_network + (size_t)b * n, n);
+  }
+  double network_secs = elapsed(&start);
+
+  int same = 1;
+  for (int b = 0; b < blocks; b++) {
+    qsort(numbers + (size_t)b * n, n, sizeof(int), compare_ints);
+  }
+  for (size_t i = 0; i < total; i++) {
+    same &= by_insertion[i] == numbers[i] && by_network[i] == numbers[i];
+  }
+
+  printf("%4d  %13.1f  %11.1f  %7.2f%s\n", n, insertion_secs * 1e9 / blocks,
+         network_secs * 1e9 / blocks, insertion_secs / network_secs,
+         same ? "" : "  WRONG");
+
+  free(by_network);
+  free(by_insertion);
+  free(numbers);
+  return same;
+}
+
+int main(int argc, char *argv[]) {
+  int blocks = argc > 1 ? atoi(argv[1]) : 1000000;
+  int v[1] = {0};
+  int ok = 1;
+
+  if (blocks < 1) {
+    fprintf(stderr, "BLOCKS must be positive\n");
+    return EXIT_FAILURE;
+  }
+  if (!sort_network(v, 1)) {
+    printf("No AVX2 on this CPU: sort_network() declines every block\n");
+    return 0;
+  }
+
+  srand(1);
+  printf("size  insertion ns  network ns  speedup\n");
+  for (int n = 4; n <= SORT_NETWORK_MAX; n += 4) {
+    ok &= benchmark(n, blocks);
+  }
+  return ok ? 0 : EXIT_FAILURE;
+}
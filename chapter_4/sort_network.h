@@ -0,0 +1,156 @@
+/*
+ * Sorting networks for the leaves of a sort
+ *
+ *   int sort_network(int v[], int n);
+ *
+ * sorts v[0]...v[n-1] and returns 1 if n is at most SORT_NETWORK_MAX and the
+ * CPU has AVX2; otherwise it leaves v alone and returns 0, and the caller
+ * sorts the range its own way (insertion sort, say).
+ *
+ * Insertion sort on a handful of random values spends its time on branches
+ * that mispredict about half the time. A sorting network does a fixed
+ * sequence of compare-exchanges instead, and with AVX2 eight of them run in
+ * one min and one max instruction, with no branch at all. The block is padded
+ * to 8, 16 or 32 values with INT_MAX, which sorts to the end and is dropped.
+ *
+ * Eight values in one register are sorted by a bitonic sorting network of six
+ * steps; each step swaps lanes at distance 4, 2 or 1, takes the min and the
+ * max with the original, and blends them according to which lane of each pair
+ * should get the smaller value. Two sorted registers are merged by comparing
+ * the first with the second reversed, which leaves the eight smallest values
+ * in one register and the eight largest in the other, each of them a bitonic
+ * sequence that the last three steps sort. Sixteen and thirty-two values are
+ * built up the same way.
+ *
+ * The AVX2 code is compiled with the target("avx2") attribute, so the rest of
+ * the program does not need -mavx2 and still runs on CPUs without it;
+ * __builtin_cpu_supports() picks the path at run time. On other compilers or
+ * architectures sort_network() always returns 0.
+ */
+#ifndef SORT_NETWORK_H
+#define SORT_NETWORK_H
+
+#include <limits.h>
+#include <string.h>
+
+#define SORT_NETWORK_MAX 32 // largest block sort_network() accepts
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+
+#define SORT_NETWORK_AVX2 __attribute__((target("avx2")))
+
+// Compare-exchange lanes at distance 1, 2 or 4; bit i of blend set means lane
+// i keeps the larger value of its pair
+#define SORT_NETWORK_STEP(x, swapped, blend)                                   \
+  _mm256_blend_epi32(_mm256_min_epi32(x, swapped),                             \
+                     _mm256_max_epi32(x, swapped), blend)
+
+SORT_NETWORK_AVX2 static inline __m256i sort_network_dist1(__m256i x) {
+  return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+SORT_NETWORK_AVX2 static inline __m256i sort_network_dist2(__m256i x) {
+  return _mm256_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+SORT_NETWORK_AVX2 static inline __m256i sort_network_dist4(__m256i x) {
+  return _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+SORT_NETWORK_AVX2 static inline __m256i sort_network_reverse(__m256i x) {
+  return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1,
+                                                          0));
+}
+
+// Sort a bitonic sequence of 8 values
+SORT_NETWORK_AVX2 static inline __m256i sort_network_merge8(__m256i x) {
+  x = SORT_NETWORK_STEP(x, sort_network_dist4(x), 0xf0);
+  x = SORT_NETWORK_STEP(x, sort_network_dist2(x), 0xcc);
+  return SORT_NETWORK_STEP(x, sort_network_dist1(x), 0xaa);
+}
+
+// Sort 8 values: pairs, then runs of 4 (alternately up and down), then all
+SORT_NETWORK_AVX2 static inline __m256i sort_network_sort8(__m256i x) {
+  x = SORT_NETWORK_STEP(x, sort_network_dist1(x), 0x66);
+  x = SORT_NETWORK_STEP(x, sort_network_dist2(x), 0x3c);
+  x = SORT_NETWORK_STEP(x, sort_network_dist1(x), 0x5a);
+  return sort_network_merge8(x);
+}
+
+// Merge sorted *a and *b so that *a holds the 8 smallest values, in order
+SORT_NETWORK_AVX2 static inline void sort_network_merge16(__m256i *a,
+                                                          __m256i *b) {
+  __m256i r = sort_network_reverse(*b);
+  __m256i lo = _mm256_min_epi32(*a, r);
+  __m256i hi = _mm256_max_epi32(*a, r);
+  *a = sort_network_merge8(lo);
+  *b = sort_network_merge8(hi);
+}
+
+// Sort a bitonic sequence of 16 values held in a and b
+SORT_NETWORK_AVX2 static inline void sort_network_bitonic16(__m256i *a,
+                                                            __m256i *b) {
+  __m256i lo = _mm256_min_epi32(*a, *b);
+  __m256i hi = _mm256_max_epi32(*a, *b);
+  *a = sort_network_merge8(lo);
+  *b = sort_network_merge8(hi);
+}
+
+SORT_NETWORK_AVX2 static void sort_network_avx2(int v[], int n) {
+  int buf[SORT_NETWORK_MAX] __attribute__((aligned(32)));
+  int blocks = n <= 8 ? 1 : n <= 16 ? 2 : 4;
+  __m256i x[4];
+
+  memcpy(buf, v, sizeof(int) * n);
+  for (int i = n; i < 8 * blocks; i++) {
+    buf[i] = INT_MAX; // padding sorts to the end
+  }
+  for (int i = 0; i < blocks; i++) {
+    x[i] = sort_network_sort8(_mm256_load_si256((__m256i *)buf + i));
+  }
+
+  if (blocks >= 2) {
+    sort_network_merge16(&x[0], &x[1]);
+  }
+  if (blocks == 4) {
+    sort_network_merge16(&x[2], &x[3]);
+
+    // Merge the two sorted halves of 16: x[0..1] and x[2..3] reversed
+    __m256i r2 = sort_network_reverse(x[3]);
+    __m256i r3 = sort_network_reverse(x[2]);
+    __m256i lo0 = _mm256_min_epi32(x[0], r2), hi0 = _mm256_max_epi32(x[0], r2);
+    __m256i lo1 = _mm256_min_epi32(x[1], r3), hi1 = _mm256_max_epi32(x[1], r3);
+    sort_network_bitonic16(&lo0, &lo1);
+    sort_network_bitonic16(&hi0, &hi1);
+    x[0] = lo0, x[1] = lo1, x[2] = hi0, x[3] = hi1;
+  }
+
+  for (int i = 0; i < blocks; i++) {
+    _mm256_store_si256((__m256i *)buf + i, x[i]);
+  }
+  memcpy(v, buf, sizeof(int) * n);
+}
+
+static inline int sort_network(int v[], int n) {
+  // Reads a flag filled in once at startup, so it is cheap to ask every time
+  if (n > SORT_NETWORK_MAX || !__builtin_cpu_supports("avx2")) {
+    return 0;
+  }
+  if (n > 1) {
+    sort_network_avx2(v, n);
+  }
+  return 1;
+}
+
+#else
+
+static inline int sort_network(int v[], int n) {
+  (void)v;
+  (void)n;
+  return 0;
+}
+
+#endif
+
+#endif